@@ -0,0 +1,200 @@
+/* Microbenchmark harness for the MCAPTester comparison kernels. Each case is
+ * timed with adaptive iteration counts until it has run for a minimum wall
+ * time, and reported as nanoseconds and (on x86) cycles per element, so
+ * kernel regressions show up release over release.
+ *
+ * Run with: MCAP_tester_benchmark [minimum_ms_per_case]
+ */
+
+#include "MCAP_tester.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define MCAP_BENCHMARK_HAS_RDTSC 1
+#endif
+
+namespace {
+
+double minimum_ms_per_case = 50.0;
+
+/* Times "body" (which must process "elements" elements per call) with an
+ * adaptive iteration count and prints one result line. */
+template <typename Body>
+void run_case(const char *name, std::size_t elements, Body body) {
+  typedef std::chrono::steady_clock Clock;
+
+  std::size_t iterations = 1;
+  double elapsed_ms = 0.0;
+#if defined(MCAP_BENCHMARK_HAS_RDTSC)
+  unsigned long long elapsed_cycles = 0;
+#endif
+
+  for (;;) {
+    Clock::time_point start_time = Clock::now();
+#if defined(MCAP_BENCHMARK_HAS_RDTSC)
+    unsigned long long start_cycles = __rdtsc();
+#endif
+    for (std::size_t i = 0; i < iterations; i++) {
+      body();
+    }
+#if defined(MCAP_BENCHMARK_HAS_RDTSC)
+    elapsed_cycles = __rdtsc() - start_cycles;
+#endif
+    elapsed_ms = std::chrono::duration_cast<std::chrono::duration<double,
+                                                                  std::milli>>(
+                     Clock::now() - start_time)
+                     .count();
+    if (elapsed_ms >= minimum_ms_per_case) {
+      break;
+    }
+    if (iterations >= (static_cast<std::size_t>(1) << 40)) {
+      /* Body is too cheap to time (likely folded away); report as-is. */
+      break;
+    }
+    iterations *= 4;
+  }
+
+  double total_elements =
+      static_cast<double>(elements) * static_cast<double>(iterations);
+  double ns_per_element = (elapsed_ms * 1e6) / total_elements;
+#if defined(MCAP_BENCHMARK_HAS_RDTSC)
+  double cycles_per_element =
+      static_cast<double>(elapsed_cycles) / total_elements;
+  std::printf("%-40s %12zu iters %10.4f ns/elem %10.4f cyc/elem\n", name,
+              iterations, ns_per_element, cycles_per_element);
+#else
+  std::printf("%-40s %12zu iters %10.4f ns/elem\n", name, iterations,
+              ns_per_element);
+#endif
+  std::fflush(stdout);
+}
+
+template <typename T>
+void fill_pair(std::vector<T> &actual, std::vector<T> &expected,
+               std::size_t size, double fail_ratio) {
+  actual.resize(size);
+  expected.resize(size);
+  std::size_t fail_stride =
+      (fail_ratio > 0.0)
+          ? static_cast<std::size_t>(1.0 / fail_ratio)
+          : (size + 1);
+  for (std::size_t i = 0; i < size; i++) {
+    actual[i] = static_cast<T>(i % 251) * static_cast<T>(0.5);
+    expected[i] = actual[i];
+    if ((fail_stride <= size) && ((i % fail_stride) == (fail_stride - 1))) {
+      expected[i] += static_cast<T>(1);
+    }
+  }
+}
+
+template <typename T>
+void benchmark_vector_sizes(const char *type_name) {
+  static const std::size_t sizes[] = {4,      64,      1024,    16384,
+                                      262144, 1048576, 10485760};
+
+  for (std::size_t s = 0; s < (sizeof(sizes) / sizeof(sizes[0])); s++) {
+    std::size_t size = sizes[s];
+
+    Tester::MCAPTester<T> tester;
+    std::vector<T> actual;
+    std::vector<T> expected;
+
+    fill_pair(actual, expected, size, 0.0);
+    char name[96];
+    std::snprintf(name, sizeof(name), "vector<%s>/%zu/pass", type_name, size);
+    run_case(name, size, [&]() {
+      tester.expect_near(actual, expected, static_cast<T>(1e-6), "bench", 0);
+    });
+
+    fill_pair(actual, expected, size, 0.01);
+    tester.enable_deferred_reporting(1);
+    std::snprintf(name, sizeof(name), "vector<%s>/%zu/fail1%%", type_name,
+                  size);
+    run_case(name, size, [&]() {
+      tester.expect_near(actual, expected, static_cast<T>(1e-6), "bench", 0);
+      tester.reset_test_failed_flag();
+    });
+  }
+}
+
+template <typename T, std::size_t N>
+void benchmark_array(const char *type_name) {
+  Tester::MCAPTester<T> tester;
+  std::array<T, N> actual;
+  std::array<T, N> expected;
+  for (std::size_t i = 0; i < N; i++) {
+    actual[i] = static_cast<T>(i);
+    expected[i] = actual[i];
+  }
+
+  char name[96];
+  std::snprintf(name, sizeof(name), "array<%s,%zu>/pass", type_name, N);
+  run_case(name, N, [&]() {
+    tester.expect_near(actual, expected, static_cast<T>(1e-6),
+                       std::string("bench"));
+  });
+}
+
+template <typename T>
+void benchmark_nested(const char *type_name, std::size_t rows,
+                      std::size_t columns) {
+  Tester::MCAPTester<T> tester;
+  std::vector<std::vector<T>> actual(rows, std::vector<T>(columns));
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t j = 0; j < columns; j++) {
+      actual[i][j] = static_cast<T>((i * columns + j) % 251);
+    }
+  }
+  std::vector<std::vector<T>> expected = actual;
+
+  char name[96];
+  std::snprintf(name, sizeof(name), "nested<%s>/%zux%zu/pass", type_name,
+                rows, columns);
+  run_case(name, rows * columns, [&]() {
+    tester.expect_near(actual, expected, static_cast<T>(1e-6),
+                       std::string("bench"));
+  });
+}
+
+template <typename T> void benchmark_scalar(const char *type_name) {
+  Tester::MCAPTester<T> tester;
+  /* volatile input keeps the compiler from folding the whole call away. */
+  volatile T actual_source = static_cast<T>(1);
+  char name[96];
+  std::snprintf(name, sizeof(name), "scalar<%s>/pass", type_name);
+  run_case(name, 1, [&]() {
+    tester.expect_near(static_cast<T>(actual_source), static_cast<T>(1),
+                       static_cast<T>(1e-6), "bench", 0);
+  });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    minimum_ms_per_case = std::atof(argv[1]);
+  }
+
+  benchmark_scalar<float>("float");
+  benchmark_scalar<double>("double");
+
+  benchmark_array<float, 4>("float");
+  benchmark_array<float, 16>("float");
+  benchmark_array<double, 4>("double");
+  benchmark_array<double, 16>("double");
+
+  benchmark_vector_sizes<float>("float");
+  benchmark_vector_sizes<double>("double");
+
+  benchmark_nested<float>("float", 256, 256);
+  benchmark_nested<double>("double", 256, 256);
+
+  return 0;
+}
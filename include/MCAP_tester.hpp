@@ -1,132 +1,2053 @@
-#ifndef MCAP_TESTER_HPP
-#define MCAP_TESTER_HPP
-
-#include <array>
-#include <cmath>
-#include <iostream>
-#include <stdexcept>
-#include <string>
-#include <vector>
-
-namespace Tester {
-
-template <typename T> class MCAPTester {
-public:
-  MCAPTester() : test_failed_flag(false) {}
-
-  void expect_near(T actual, T expected, T tolerance,
-                   const std::string &message) {
-    if (std::abs(actual - expected) <= tolerance) {
-      /* Do Nothing. */
-    } else {
-      std::cout << "FAILURE: " << message << std::endl;
-      std::cout << std::endl;
-      test_failed_flag = true;
-    }
-  }
-
-  void expect_near(std::vector<T> actual, std::vector<T> expected, T tolerance,
-                   const std::string &message) {
-    if (actual.size() != expected.size()) {
-      std::cout << "FAILURE: " << message << " Size mismatch." << std::endl;
-      std::cout << std::endl;
-      test_failed_flag = true;
-      return;
-    }
-
-    for (size_t i = 0; i < actual.size(); i++) {
-      if (std::abs(actual[i] - expected[i]) <= tolerance) {
-        /* Do Nothing. */
-      } else {
-        std::cout << "FAILURE: " << message << " Element mismatch."
-                  << std::endl;
-        std::cout << std::endl;
-        test_failed_flag = true;
-        return;
-      }
-    }
-  }
-
-  template <std::size_t N>
-  void expect_near(const std::array<T, N> &actual,
-                   const std::array<T, N> &expected, T tolerance,
-                   const std::string &message) {
-    for (std::size_t i = 0; i < N; ++i) {
-      if (std::abs(actual[i] - expected[i]) <= tolerance) {
-        /* Do Nothing. */
-      } else {
-        std::cout << "FAILURE: " << message << " Element mismatch."
-                  << std::endl;
-        std::cout << std::endl;
-        test_failed_flag = true;
-        return;
-      }
-    }
-  }
-
-  void expect_near(std::vector<std::vector<T>> actual,
-                   std::vector<std::vector<T>> expected, T tolerance,
-                   const std::string &message) {
-    if (actual.size() != expected.size()) {
-      std::cout << "FAILURE: " << message << " Size mismatch." << std::endl;
-      std::cout << std::endl;
-      test_failed_flag = true;
-      return;
-    }
-
-    for (size_t i = 0; i < actual.size(); i++) {
-      if (actual[i].size() != expected[i].size()) {
-        std::cout << "FAILURE: " << message << " Size mismatch. " << std::endl;
-        std::cout << std::endl;
-        test_failed_flag = true;
-        return;
-      }
-
-      for (size_t j = 0; j < actual[i].size(); j++) {
-        if (std::abs(actual[i][j] - expected[i][j]) <= tolerance) {
-          /* Do Nothing. */
-        } else {
-          std::cout << "FAILURE: " << message << " Element mismatch."
-                    << std::endl;
-          std::cout << std::endl;
-          test_failed_flag = true;
-          return;
-        }
-      }
-    }
-  }
-
-  template <std::size_t M, std::size_t N>
-  void expect_near(const std::array<std::array<T, N>, M> &actual,
-                   const std::array<std::array<T, N>, M> &expected, T tolerance,
-                   const std::string &message) {
-    for (std::size_t i = 0; i < M; ++i) {
-      for (std::size_t j = 0; j < N; ++j) {
-        if (std::abs(actual[i][j] - expected[i][j]) <= tolerance) {
-          /* Do Nothing. */
-        } else {
-          std::cout << "FAILURE: " << message << " Element mismatch."
-                    << std::endl;
-          std::cout << std::endl;
-          test_failed_flag = true;
-          return;
-        }
-      }
-    }
-  }
-
-  void throw_error_if_test_failed() {
-    if (test_failed_flag) {
-      throw std::runtime_error("Test failed.");
-    }
-  }
-
-  void reset_test_failed_flag() { test_failed_flag = false; }
-
-private:
-  bool test_failed_flag = false;
-};
-
-} // namespace Tester
-
-#endif // MCAP_TESTER_HPP
+#ifndef MCAP_TESTER_HPP
+#define MCAP_TESTER_HPP
+
+#include "MCAP_tester_file.hpp"
+#include "MCAP_tester_kernel.hpp"
+#if defined(MCAP_TESTER_USE_DISPATCH)
+#include "MCAP_tester_dispatch.hpp"
+#endif
+#include "MCAP_tester_parallel.hpp"
+#include "MCAP_tester_span.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Opt-in assertion timing. When MCAP_TESTER_ENABLE_PROFILING is not defined
+ * the scope macro expands to nothing, so the default build keeps zero
+ * instrumentation overhead. */
+#if defined(MCAP_TESTER_ENABLE_PROFILING)
+#define MCAP_TESTER_PROFILE_SCOPE(message, element_count)                      \
+  ProfileScope profile_scope_instance(this, (message), (element_count))
+#else
+#define MCAP_TESTER_PROFILE_SCOPE(message, element_count)
+#endif
+
+namespace Tester {
+
+/* FirstFailure stops a sweep at the first out-of-tolerance element.
+ * CountAll keeps scanning branch-free and accumulates the failure count and
+ * the maximum observed error across the whole range. */
+enum class ScanPolicy { FirstFailure, CountAll };
+
+/* How tolerance is interpreted. Absolute: |a-b| <= tol. Relative: |a-b| <=
+ * tol * max(|a|,|b|). Ulp: the integer-domain step distance between a and b
+ * is at most tol (truncated to a whole ULP count); non-floating-point
+ * element types fall back to Absolute. */
+enum class ComparisonMode { Absolute, Relative, Ulp };
+
+/* Compile-time tolerance profiles for the profiled expect_near overloads.
+ * ExactMatch compares bitwise: the bulk pass is a memcmp-class sweep with no
+ * per-element arithmetic, so two NaNs with the same payload compare equal.
+ * StaticTol bakes Num/Den into the instantiation, so the tolerance reaches
+ * the inlined kernel as an immediate operand instead of a loaded runtime
+ * value. */
+struct ExactMatch {
+  static const bool bitwise = true;
+  template <typename U> static U tolerance() { return static_cast<U>(0); }
+};
+
+template <long long Num, long long Den = 1> struct StaticTol {
+  static_assert(Den != 0, "StaticTol denominator must be non-zero.");
+  static const bool bitwise = false;
+  template <typename U> static U tolerance() {
+    return static_cast<U>(Num) / static_cast<U>(Den);
+  }
+};
+
+/* Error statistics from the most recent contiguous comparison when
+ * statistics collection is enabled. Errors are absolute differences widened
+ * to double, so one struct serves every element type. */
+struct ComparisonStats {
+  double max_error;
+  double mean_error;
+  double rms_error;
+  std::size_t element_count;
+};
+
+template <typename T> class MCAPTester {
+private:
+  /* Borrowed view of an assertion message. The text is only copied (into the
+   * message arena) when a failure is actually recorded, so passing message
+   * arguments never allocates on the passing path. "id" is negative for the
+   * std::string overloads and the caller-supplied test id otherwise. */
+  struct MessageRef {
+    const char *text;
+    std::size_t length;
+    int id;
+  };
+
+  static MessageRef make_message(const std::string &message) {
+    MessageRef reference;
+    reference.text = message.c_str();
+    reference.length = message.size();
+    reference.id = -1;
+    return reference;
+  }
+
+  static MessageRef make_message(const char *message, int test_id) {
+    MessageRef reference;
+    reference.text = message;
+    reference.length = std::strlen(message);
+    reference.id = test_id;
+    return reference;
+  }
+
+public:
+  MCAPTester() : deferred_reporting_enabled(false) {
+    group_records.reserve(GROUP_RECORD_RESERVE);
+  }
+
+  void expect_near(T actual, T expected, T tolerance,
+                   const std::string &message) {
+    expect_near_scalar(actual, expected, tolerance, make_message(message));
+  }
+
+  /* Message-lite overloads: a string literal plus an integer test id, so the
+   * all-pass path constructs no std::string temporaries. */
+  void expect_near(T actual, T expected, T tolerance, const char *message,
+                   int test_id) {
+    expect_near_scalar(actual, expected, tolerance,
+                       make_message(message, test_id));
+  }
+
+  void expect_near(Span<T> actual, Span<T> expected, T tolerance,
+                   const std::string &message) {
+    expect_near_span(actual, expected, tolerance, make_message(message));
+  }
+
+  void expect_near(Span<T> actual, Span<T> expected, T tolerance,
+                   const char *message, int test_id) {
+    expect_near_span(actual, expected, tolerance,
+                     make_message(message, test_id));
+  }
+
+  void expect_near(Span2D<T> actual, Span2D<T> expected, T tolerance,
+                   const std::string &message) {
+    expect_near_span2d(actual, expected, tolerance, make_message(message));
+  }
+
+  void expect_near(Span2D<T> actual, Span2D<T> expected, T tolerance,
+                   const char *message, int test_id) {
+    expect_near_span2d(actual, expected, tolerance,
+                       make_message(message, test_id));
+  }
+
+  /* Flat-matrix overloads: one dimension check, then a single linear sweep
+   * over the contiguous buffer — no per-row pointer chasing. */
+  void expect_near(const Matrix<T> &actual, const Matrix<T> &expected,
+                   T tolerance, const std::string &message) {
+    expect_near_span2d(actual.view(), expected.view(), tolerance,
+                       make_message(message));
+  }
+
+  void expect_near(const Matrix<T> &actual, const Matrix<T> &expected,
+                   T tolerance, const char *message, int test_id) {
+    expect_near_span2d(actual.view(), expected.view(), tolerance,
+                       make_message(message, test_id));
+  }
+
+  void expect_near(const std::vector<T> &actual,
+                   const std::vector<T> &expected, T tolerance,
+                   const std::string &message) {
+    expect_near_span(Span<T>(actual), Span<T>(expected), tolerance,
+                     make_message(message));
+  }
+
+  void expect_near(const std::vector<T> &actual,
+                   const std::vector<T> &expected, T tolerance,
+                   const char *message, int test_id) {
+    expect_near_span(Span<T>(actual), Span<T>(expected), tolerance,
+                     make_message(message, test_id));
+  }
+
+  template <std::size_t N>
+  void expect_near(const std::array<T, N> &actual,
+                   const std::array<T, N> &expected, T tolerance,
+                   const std::string &message_in) {
+    MessageRef message = make_message(message_in);
+    MCAP_TESTER_PROFILE_SCOPE(message, N);
+    note_assertion(1);
+    compare_fixed<N>(actual.data(), expected.data(), tolerance, message, 0);
+  }
+
+  void expect_near(const std::vector<std::vector<T>> &actual,
+                   const std::vector<std::vector<T>> &expected, T tolerance,
+                   const std::string &message_in) {
+    MessageRef message = make_message(message_in);
+    MCAP_TESTER_PROFILE_SCOPE(
+        message, actual.size() * (actual.empty() ? 0 : actual[0].size()));
+    note_assertion(1);
+    if (actual.size() != expected.size()) {
+      bump_failure_count(1);
+      record_failure(message, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+
+    if (parallel_pool && (scan_policy == ScanPolicy::FirstFailure) &&
+        (comparison_mode == ComparisonMode::Absolute) &&
+        (actual.size() >= parallel_row_threshold)) {
+      Parallel::RowMismatch mismatch = Parallel::first_mismatch_rows(
+          *parallel_pool, actual, expected, tolerance);
+      if (mismatch.found) {
+        bump_failure_count(1);
+        if (mismatch.size_mismatch) {
+          record_failure(message, "Size mismatch.", mismatch.row, 0,
+                         static_cast<T>(0), static_cast<T>(0));
+        } else {
+          record_failure(message,
+                         mismatch_detail(
+                             actual[mismatch.row][mismatch.column],
+                             expected[mismatch.row][mismatch.column]),
+                         mismatch.row, mismatch.column,
+                         actual[mismatch.row][mismatch.column],
+                         expected[mismatch.row][mismatch.column]);
+        }
+      }
+      return;
+    }
+
+    if (!actual.empty() &&
+        ((actual.size() * actual[0].size()) >= BLOCKED_SWEEP_MIN_ELEMENTS) &&
+        (actual[0].size() > BLOCK_TILE_COLUMNS)) {
+      bool rows_uniform = true;
+      for (std::size_t i = 0; i < actual.size(); i++) {
+        rows_uniform = rows_uniform && (actual[i].size() == actual[0].size()) &&
+                       (expected[i].size() == actual[0].size());
+      }
+      if (rows_uniform) {
+        compare_rows_blocked(actual, expected, tolerance, message);
+        return;
+      }
+    }
+
+    for (size_t i = 0; i < actual.size(); i++) {
+      if (actual[i].size() != expected[i].size()) {
+        bump_failure_count(1);
+        record_failure(message, "Size mismatch.", i, 0, static_cast<T>(0),
+                       static_cast<T>(0));
+        return;
+      }
+
+      bool row_failed =
+          compare_contiguous(actual[i].data(), expected[i].data(),
+                             actual[i].size(), tolerance, message, i, 0, 0);
+      if (row_failed && (scan_policy == ScanPolicy::FirstFailure)) {
+        return;
+      }
+    }
+  }
+
+  template <std::size_t M, std::size_t N>
+  void expect_near(const std::array<std::array<T, N>, M> &actual,
+                   const std::array<std::array<T, N>, M> &expected, T tolerance,
+                   const std::string &message_in) {
+    MessageRef message = make_message(message_in);
+    MCAP_TESTER_PROFILE_SCOPE(message, M * N);
+    note_assertion(1);
+    if (((M * N) >= BLOCKED_SWEEP_MIN_ELEMENTS) && (N > BLOCK_TILE_COLUMNS)) {
+      compare_rows_blocked(actual, expected, tolerance, message);
+      return;
+    }
+
+    for (std::size_t i = 0; i < M; ++i) {
+      bool row_failed = compare_fixed<N>(actual[i].data(), expected[i].data(),
+                                         tolerance, message, i);
+      if (row_failed && (scan_policy == ScanPolicy::FirstFailure)) {
+        return;
+      }
+    }
+  }
+
+  /* Batch form of the scalar expect_near for generated tests that would
+   * otherwise issue one call per element. All pairs are swept in a single
+   * kernel pass with a per-element absolute tolerance; the failing element at
+   * index i is reported with message id base_message_id + i, matching the id
+   * the equivalent scalar call would have used. */
+  void expect_near_batch(const T *actual, const T *expected,
+                         const T *tolerances, std::size_t size,
+                         int base_message_id) {
+    MCAP_TESTER_PROFILE_SCOPE(
+        make_message("Batch element mismatch.", base_message_id), size);
+    note_assertion(size);
+
+    if (scan_policy == ScanPolicy::CountAll) {
+      T max_difference = static_cast<T>(0);
+      std::size_t fail_count = Kernel::count_mismatch_batch(
+          actual, expected, tolerances, size, &max_difference);
+      update_max_error(max_difference);
+      if (fail_count == 0) {
+        return;
+      }
+
+      bump_failure_count(fail_count);
+      std::size_t index = 0;
+      while ((index = Kernel::first_mismatch_batch(actual, expected,
+                                                   tolerances, index, size)) <
+             size) {
+        record_failure(make_message("Batch element mismatch.",
+                                    base_message_id + static_cast<int>(index)),
+                       mismatch_detail(actual[index], expected[index]), 0,
+                       index, actual[index], expected[index]);
+        ++index;
+      }
+      return;
+    }
+
+    std::size_t index =
+        Kernel::first_mismatch_batch(actual, expected, tolerances, 0, size);
+    if (index < size) {
+      bump_failure_count(1);
+      record_failure(make_message("Batch element mismatch.",
+                                  base_message_id + static_cast<int>(index)),
+                     mismatch_detail(actual[index], expected[index]), 0, index,
+                     actual[index], expected[index]);
+    }
+  }
+
+  /* Raw pointer + length overloads for buffers that never lived in a
+   * std::vector (DMA regions, arena allocations). Same full-featured path
+   * as the Span overloads. */
+  void expect_near(const T *actual, const T *expected, std::size_t size,
+                   T tolerance, const std::string &message) {
+    expect_near_span(Span<T>(actual, size), Span<T>(expected, size),
+                     tolerance, make_message(message));
+  }
+
+  void expect_near(const T *actual, const T *expected, std::size_t size,
+                   T tolerance, const char *message, int test_id) {
+    expect_near_span(Span<T>(actual, size), Span<T>(expected, size),
+                     tolerance, make_message(message, test_id));
+  }
+
+  /* Tolerance-profile overloads: the profile type replaces the runtime
+   * tolerance argument, so the comparison specializes at compile time.
+   * expect_near<ExactMatch>(...) runs the bitwise bulk sweep regardless of
+   * the comparison mode; expect_near<StaticTol<Num, Den>>(...) feeds the
+   * constant through the regular mode dispatch. */
+  template <typename Profile>
+  void expect_near(Span<T> actual, Span<T> expected,
+                   const std::string &message) {
+    expect_near_profiled<Profile>(actual, expected, make_message(message));
+  }
+
+  template <typename Profile>
+  void expect_near(Span<T> actual, Span<T> expected, const char *message,
+                   int test_id) {
+    expect_near_profiled<Profile>(actual, expected,
+                                  make_message(message, test_id));
+  }
+
+  template <typename Profile>
+  void expect_near(const std::vector<T> &actual,
+                   const std::vector<T> &expected,
+                   const std::string &message) {
+    expect_near_profiled<Profile>(Span<T>(actual), Span<T>(expected),
+                                  make_message(message));
+  }
+
+  template <typename Profile>
+  void expect_near(const std::vector<T> &actual,
+                   const std::vector<T> &expected, const char *message,
+                   int test_id) {
+    expect_near_profiled<Profile>(Span<T>(actual), Span<T>(expected),
+                                  make_message(message, test_id));
+  }
+
+  template <typename Profile>
+  void expect_near(const T *actual, const T *expected, std::size_t size,
+                   const char *message, int test_id) {
+    expect_near_profiled<Profile>(Span<T>(actual, size),
+                                  Span<T>(expected, size),
+                                  make_message(message, test_id));
+  }
+
+  /* Iterator-pair overloads. Contiguity is decided at compile time: pointer
+   * iterators go through the vectorized contiguous core, anything else
+   * (deque ring buffers, custom containers) runs a generic element-wise
+   * sweep through the same mode dispatch, so no adapter copy into a
+   * std::vector is needed either way. */
+  template <typename Iterator>
+  void expect_near(Iterator actual_begin, Iterator actual_end,
+                   Iterator expected_begin, Iterator expected_end,
+                   T tolerance, const std::string &message) {
+    expect_near_range(actual_begin, actual_end, expected_begin, expected_end,
+                      tolerance, make_message(message));
+  }
+
+  template <typename Iterator>
+  void expect_near(Iterator actual_begin, Iterator actual_end,
+                   Iterator expected_begin, Iterator expected_end,
+                   T tolerance, const char *message, int test_id) {
+    expect_near_range(actual_begin, actual_end, expected_begin, expected_end,
+                      tolerance, make_message(message, test_id));
+  }
+
+  /* Mixed-precision overloads: actual and expected may have different
+   * element types (float model output against double golden data). Lanes
+   * are widened to the common type in registers during the sweep, so no
+   * conversion buffer or extra pass exists. The sweep always uses absolute
+   * tolerance; the comparison-mode dispatch stays homogeneous-only. */
+  template <typename ActualT, typename ExpectedT>
+  void expect_near(const ActualT *actual, const ExpectedT *expected,
+                   std::size_t size, T tolerance, const char *message,
+                   int test_id) {
+    expect_near_mixed_contiguous(actual, expected, size, tolerance,
+                                 make_message(message, test_id));
+  }
+
+  template <typename ActualT, typename ExpectedT>
+  void expect_near(const std::vector<ActualT> &actual,
+                   const std::vector<ExpectedT> &expected, T tolerance,
+                   const char *message, int test_id) {
+    MessageRef message_ref = make_message(message, test_id);
+    if (actual.size() != expected.size()) {
+      note_assertion(1);
+      bump_failure_count(1);
+      record_failure(message_ref, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+    expect_near_mixed_contiguous(actual.data(), expected.data(),
+                                 actual.size(), tolerance, message_ref);
+  }
+
+  template <typename ActualT, typename ExpectedT>
+  void expect_near(const std::vector<ActualT> &actual,
+                   const std::vector<ExpectedT> &expected, T tolerance,
+                   const std::string &message) {
+    MessageRef message_ref = make_message(message);
+    if (actual.size() != expected.size()) {
+      note_assertion(1);
+      bump_failure_count(1);
+      record_failure(message_ref, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+    expect_near_mixed_contiguous(actual.data(), expected.data(),
+                                 actual.size(), tolerance, message_ref);
+  }
+
+  /* Compares against a binary golden file written by Golden::write_file().
+   * The expected data is memory mapped (where available) and compared in
+   * place, so no parsing or copying happens on the expected side. */
+  void expect_near_file(Span<T> actual, const std::string &golden_path,
+                        T tolerance, const std::string &message) {
+    Golden::MappedFile<T> golden(golden_path);
+    if (!golden.valid()) {
+      note_assertion(1);
+      bump_failure_count(1);
+      record_failure(make_message(message), "Golden file error.", 0, 0,
+                     static_cast<T>(0), static_cast<T>(0));
+      return;
+    }
+
+    expect_near_span(actual, Span<T>(golden.data(), golden.size()), tolerance,
+                     make_message(message));
+  }
+
+  /* Compares against a delta-compressed golden file written by
+   * Golden::write_compressed_file(). Blocks are decoded one at a time into a
+   * block-sized scratch buffer and fed straight to the contiguous sweep, so
+   * the decoded baseline never materializes in full and failing indices are
+   * reported as absolute positions through the column-base offset. */
+  void expect_near_compressed_file(Span<T> actual,
+                                   const std::string &golden_path,
+                                   T tolerance, const std::string &message_in) {
+    MessageRef message = make_message(message_in);
+    Golden::CompressedFile<T> golden(golden_path);
+    note_assertion(1);
+    if (!golden.valid()) {
+      bump_failure_count(1);
+      record_failure(message, "Golden file error.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+    if (actual.size() != golden.size()) {
+      bump_failure_count(1);
+      record_failure(message, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+
+    MCAP_TESTER_PROFILE_SCOPE(message, actual.size());
+    std::vector<T> scratch(Golden::COMPRESSED_BLOCK_ELEMENTS);
+    std::size_t offset = 0;
+    std::size_t block = 0;
+    while ((block = golden.decode_block(scratch.data())) > 0) {
+      bool block_failed =
+          compare_contiguous(actual.data() + offset, scratch.data(), block,
+                             tolerance, message, 0, 0, offset);
+      offset += block;
+      if (block_failed && (scan_policy == ScanPolicy::FirstFailure)) {
+        return;
+      }
+    }
+
+    if (offset != actual.size()) {
+      bump_failure_count(1);
+      record_failure(message, "Golden file error.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+    }
+  }
+
+  /* Incremental comparator for datasets too large to hold as full vectors.
+   * Successive chunks of actual/expected data are pushed through the same
+   * tolerance kernel while only the caller's chunk buffers stay resident;
+   * finalize() folds the result into the owning tester. */
+  class ChunkedComparator {
+  public:
+    void push_chunk(const T *actual, const T *expected, std::size_t size) {
+      if (finalized) {
+        return;
+      }
+      if (failed && (owner->scan_policy == ScanPolicy::FirstFailure)) {
+        element_offset += size;
+        return;
+      }
+
+      if (owner->scan_policy == ScanPolicy::CountAll) {
+        T max_difference = static_cast<T>(0);
+        std::size_t chunk_failures = owner->run_count_mismatch(
+            actual, expected, size, tolerance, &max_difference);
+        max_error = (max_difference > max_error) ? max_difference : max_error;
+        if ((chunk_failures > 0) && (!failed)) {
+          std::size_t index =
+              owner->run_first_mismatch(actual, expected, size, tolerance);
+          failed = true;
+          first_fail_index = element_offset + index;
+          fail_actual = actual[index];
+          fail_expected = expected[index];
+        }
+        fail_count += chunk_failures;
+      } else {
+        std::size_t index =
+            owner->run_first_mismatch(actual, expected, size, tolerance);
+        if (index < size) {
+          failed = true;
+          first_fail_index = element_offset + index;
+          fail_actual = actual[index];
+          fail_expected = expected[index];
+          fail_count = 1;
+        }
+      }
+
+      element_offset += size;
+    }
+
+    /* Total number of elements pushed so far. */
+    std::size_t element_count() const { return element_offset; }
+
+    void finalize() {
+      if (finalized) {
+        return;
+      }
+      finalized = true;
+
+      owner->note_assertion(1);
+      if (owner->scan_policy == ScanPolicy::CountAll) {
+        owner->update_max_error(max_error);
+      }
+      if (failed) {
+        owner->bump_failure_count(fail_count);
+        owner->record_failure(MCAPTester::make_message(message),
+                              mismatch_detail(fail_actual, fail_expected), 0,
+                              first_fail_index, fail_actual, fail_expected);
+      }
+    }
+
+  private:
+    friend class MCAPTester<T>;
+
+    ChunkedComparator(MCAPTester *owner_in, T tolerance_in,
+                      const std::string &message_in)
+        : owner(owner_in), tolerance(tolerance_in), message(message_in),
+          element_offset(0), failed(false), finalized(false),
+          first_fail_index(0), fail_actual(static_cast<T>(0)),
+          fail_expected(static_cast<T>(0)), fail_count(0),
+          max_error(static_cast<T>(0)) {}
+
+    MCAPTester *owner;
+    T tolerance;
+    std::string message;
+    std::size_t element_offset;
+    bool failed;
+    bool finalized;
+    std::size_t first_fail_index;
+    T fail_actual;
+    T fail_expected;
+    std::size_t fail_count;
+    T max_error;
+  };
+
+  ChunkedComparator begin_expect_near(T tolerance,
+                                      const std::string &message) {
+    return ChunkedComparator(this, tolerance, message);
+  }
+
+  void set_scan_policy(ScanPolicy policy) { scan_policy = policy; }
+
+  void set_comparison_mode(ComparisonMode mode) { comparison_mode = mode; }
+
+  /* Number of out-of-tolerance elements seen since the last reset, merged
+   * across the per-thread shards. Under FirstFailure each failing assertion
+   * contributes one; under CountAll every failing element is counted. */
+  std::size_t failure_count() const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+      total += shards[i].fail_count.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  /* Largest absolute difference seen by CountAll sweeps since the last
+   * reset, merged across the per-thread shards. */
+  T max_observed_error() const {
+    T merged = static_cast<T>(0);
+    for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+      T shard_max = shards[i].max_error.load(std::memory_order_relaxed);
+      merged = (shard_max > merged) ? shard_max : merged;
+    }
+    return merged;
+  }
+
+  /* Compare the rows of large nested-vector assertions on a thread pool.
+   * Assertions with fewer rows than the threshold stay on the serial path so
+   * small comparisons pay no dispatch cost. */
+  void enable_parallel_comparison(std::size_t thread_count = 0) {
+    if (thread_count == 0) {
+      thread_count = static_cast<std::size_t>(
+          std::thread::hardware_concurrency());
+    }
+    parallel_pool = std::make_shared<Parallel::ThreadPool>(thread_count);
+  }
+
+  void disable_parallel_comparison() { parallel_pool.reset(); }
+
+  /* Asynchronous assertion pipeline: expect_near_async enqueues the
+   * comparison on a background worker so memory-bound asserting overlaps the
+   * compute-heavy model step between assertions. Results land in the
+   * per-thread shards, which are already safe to write from the worker;
+   * throw_error_if_test_failed() (or wait_async_assertions()) is the
+   * synchronization point that drains the queue. */
+  void enable_async_assertions() {
+    if (!async_pool) {
+      async_pool = std::make_shared<Parallel::ThreadPool>(1);
+    }
+  }
+
+  void wait_async_assertions() {
+    if (async_pool) {
+      async_pool->wait_idle();
+    }
+  }
+
+  void disable_async_assertions() {
+    wait_async_assertions();
+    async_pool.reset();
+  }
+
+  /* Optional comparison cache for soak loops that re-assert identical data.
+   * The actual and expected buffers (plus tolerance, scan policy and
+   * comparison mode) are digested and memoized per message id; a repeat
+   * invocation whose digest matches a previously-passed one skips the
+   * element-wise sweep. Only the message-lite overloads participate (the id
+   * keys the cache); std::string-message assertions always compare. Like
+   * grouping, the cache is driver-side state and not thread-safe. */
+  void enable_comparison_cache() {
+    comparison_cache_enabled = true;
+    for (std::size_t i = 0; i < COMPARISON_CACHE_SIZE; i++) {
+      comparison_cache[i].used = false;
+    }
+    comparison_cache_hit_count = 0;
+  }
+
+  void disable_comparison_cache() { comparison_cache_enabled = false; }
+
+  std::size_t comparison_cache_hits() const {
+    return comparison_cache_hit_count;
+  }
+
+  /* Statistics collection for trend dashboards. When enabled, the
+   * contiguous sweeps accumulate max/mean/RMS absolute error in the same
+   * pass as the tolerance check, so no second pass over the buffers is
+   * needed. The statistics sweep always checks absolute tolerance (like the
+   * mixed-precision path); like grouping, the latched result is driver-side
+   * state and not thread-safe. */
+  void enable_comparison_statistics() {
+    comparison_statistics_enabled = true;
+    last_stats = ComparisonStats();
+  }
+
+  void disable_comparison_statistics() {
+    comparison_statistics_enabled = false;
+  }
+
+  /* Statistics of the most recent contiguous comparison. */
+  ComparisonStats last_comparison_stats() const { return last_stats; }
+
+  /* Owned-copy variants: the operands are copied once into the task, so the
+   * caller may reuse its buffers immediately. Falls back to the synchronous
+   * path when async mode is not enabled. */
+  void expect_near_async(const std::vector<T> &actual,
+                         const std::vector<T> &expected, T tolerance,
+                         const std::string &message) {
+    if (!async_pool) {
+      expect_near(actual, expected, tolerance, message);
+      return;
+    }
+
+    std::shared_ptr<std::vector<T>> actual_copy =
+        std::make_shared<std::vector<T>>(actual);
+    std::shared_ptr<std::vector<T>> expected_copy =
+        std::make_shared<std::vector<T>>(expected);
+    std::shared_ptr<std::string> message_copy =
+        std::make_shared<std::string>(message);
+    MCAPTester *self = this;
+    async_pool->run([self, actual_copy, expected_copy, tolerance,
+                     message_copy]() {
+      self->expect_near_span(Span<T>(*actual_copy), Span<T>(*expected_copy),
+                             tolerance, make_message(*message_copy));
+    });
+  }
+
+  void expect_near_async(const std::vector<T> &actual,
+                         const std::vector<T> &expected, T tolerance,
+                         const char *message, int test_id) {
+    if (!async_pool) {
+      expect_near(actual, expected, tolerance, message, test_id);
+      return;
+    }
+
+    std::shared_ptr<std::vector<T>> actual_copy =
+        std::make_shared<std::vector<T>>(actual);
+    std::shared_ptr<std::vector<T>> expected_copy =
+        std::make_shared<std::vector<T>>(expected);
+    MCAPTester *self = this;
+    async_pool->run([self, actual_copy, expected_copy, tolerance, message,
+                     test_id]() {
+      self->expect_near_span(Span<T>(*actual_copy), Span<T>(*expected_copy),
+                             tolerance, make_message(message, test_id));
+    });
+  }
+
+  void expect_near_async(const Matrix<T> &actual, const Matrix<T> &expected,
+                         T tolerance, const char *message, int test_id) {
+    if (!async_pool) {
+      expect_near(actual, expected, tolerance, message, test_id);
+      return;
+    }
+
+    std::shared_ptr<Matrix<T>> actual_copy =
+        std::make_shared<Matrix<T>>(actual);
+    std::shared_ptr<Matrix<T>> expected_copy =
+        std::make_shared<Matrix<T>>(expected);
+    MCAPTester *self = this;
+    async_pool->run([self, actual_copy, expected_copy, tolerance, message,
+                     test_id]() {
+      self->expect_near_span2d(actual_copy->view(), expected_copy->view(),
+                               tolerance, make_message(message, test_id));
+    });
+  }
+
+  /* No-copy variant for double-buffered callers: the viewed buffers must
+   * stay valid until the queue is drained. */
+  void expect_near_async(Span<T> actual, Span<T> expected, T tolerance,
+                         const char *message, int test_id) {
+    if (!async_pool) {
+      expect_near(actual, expected, tolerance, message, test_id);
+      return;
+    }
+
+    MCAPTester *self = this;
+    async_pool->run([self, actual, expected, tolerance, message, test_id]() {
+      self->expect_near_span(actual, expected, tolerance,
+                             make_message(message, test_id));
+    });
+  }
+
+  void set_parallel_row_threshold(std::size_t row_threshold) {
+    parallel_row_threshold = row_threshold;
+  }
+
+  /* Record failures into a preallocated in-memory log instead of writing to
+   * std::cout per failure. The log is emitted in one buffered write when
+   * throw_error_if_test_failed() runs. Failures beyond "capacity" are counted
+   * but not stored, so the failure path stays allocation free. */
+  void enable_deferred_reporting(std::size_t capacity) {
+    deferred_reporting_enabled = true;
+    std::size_t shard_capacity = (capacity + SHARD_COUNT - 1) / SHARD_COUNT;
+    for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+      shards[i].failure_log.clear();
+      shards[i].failure_log.reserve(shard_capacity);
+      shards[i].message_arena.clear();
+      shards[i].message_arena.reserve(shard_capacity *
+                                      MESSAGE_ARENA_BYTES_PER_RECORD);
+      shards[i].dropped_failure_count = 0;
+    }
+  }
+
+  void disable_deferred_reporting() {
+    flush_failure_log();
+    deferred_reporting_enabled = false;
+  }
+
+  /* Serializes the deferred failure log as a binary report (fixed-width
+   * records: message id, detail code, position, both values, error) in one
+   * buffered write, so CI pipelines ingest results without scraping text.
+   * Requires deferred reporting; call before throw_error_if_test_failed(),
+   * which flushes and clears the log. The log is left intact, so the text
+   * report still follows. Returns false if the file could not be written. */
+  bool write_report(const std::string &path) {
+    wait_async_assertions();
+
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+      ShardLogGuard guard(shards[i]);
+      total += shards[i].failure_log.size();
+    }
+
+    std::vector<Report::ReportRecord> records;
+    records.reserve(total);
+    for (std::size_t s = 0; s < SHARD_COUNT; s++) {
+      Shard &shard = shards[s];
+      ShardLogGuard guard(shard);
+      for (std::size_t i = 0; i < shard.failure_log.size(); i++) {
+        const FailureRecord &source = shard.failure_log[i];
+        Report::ReportRecord record;
+        record.message_id = static_cast<std::int32_t>(source.message_id);
+        record.detail_code = detail_to_code(source.detail);
+        record.row = static_cast<std::uint64_t>(source.row);
+        record.column = static_cast<std::uint64_t>(source.column);
+        if (detail_has_values(source.detail)) {
+          record.actual_value = static_cast<double>(source.actual_value);
+          record.expected_value = static_cast<double>(source.expected_value);
+          record.error = static_cast<double>(
+              abs_difference(source.actual_value, source.expected_value));
+        } else {
+          record.actual_value = 0.0;
+          record.expected_value = 0.0;
+          record.error = 0.0;
+        }
+        records.push_back(record);
+      }
+    }
+
+    return Report::write_report(path, records);
+  }
+
+  void throw_error_if_test_failed() {
+    wait_async_assertions();
+    flush_failure_log();
+    bool any_failed = false;
+    for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+      any_failed = any_failed || shards[i].failed.load(std::memory_order_relaxed);
+    }
+    if (any_failed) {
+      throw std::runtime_error("Test failed.");
+    }
+  }
+
+#if defined(MCAP_TESTER_ENABLE_PROFILING)
+  /* Prints the per-message latency table accumulated by the profile scopes:
+   * call count, total element count, total/min/max latency and a log2
+   * nanosecond histogram per assertion site. */
+  void dump_profile() {
+    std::ostringstream report;
+    report << "=== MCAPTester assertion profile ===\n";
+    for (std::size_t i = 0; i < PROFILE_TABLE_SIZE; i++) {
+      const ProfileSlot &slot = profile_table[i];
+      if (!slot.used) {
+        continue;
+      }
+
+      report << slot.label << ": calls=" << slot.call_count
+             << " elements=" << slot.element_total
+             << " total_ns=" << slot.total_ns << " min_ns=" << slot.min_ns
+             << " max_ns=" << slot.max_ns << " histogram=[";
+      for (std::size_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+        if (slot.latency_histogram[b] > 0) {
+          report << " 2^" << b << "ns:" << slot.latency_histogram[b];
+        }
+      }
+      report << " ]\n";
+    }
+    if (profile_overflow_count > 0) {
+      report << "(" << profile_overflow_count
+             << " samples fell outside the fixed profile table)\n";
+    }
+
+    std::cout << report.str() << std::flush;
+  }
+#else
+  void dump_profile() {
+    std::cout << "MCAPTester profiling is disabled. Define "
+                 "MCAP_TESTER_ENABLE_PROFILING to collect assertion timings."
+              << std::endl;
+  }
+#endif
+
+  void reset_test_failed_flag() {
+    for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+      shards[i].failed.store(false, std::memory_order_relaxed);
+      shards[i].fail_count.store(0, std::memory_order_relaxed);
+      shards[i].assertion_count.store(0, std::memory_order_relaxed);
+      shards[i].max_error.store(static_cast<T>(0), std::memory_order_relaxed);
+      shards[i].failure_log.clear();
+      shards[i].message_arena.clear();
+      shards[i].dropped_failure_count = 0;
+    }
+  }
+
+  /* Number of assertions issued since the last reset, merged across the
+   * per-thread shards. Batch calls count one per element. */
+  std::size_t assertion_count() const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < SHARD_COUNT; i++) {
+      total += shards[i].assertion_count.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  /* Nested test groups. begin_group(id)/end_group() bracket a section of
+   * assertions; each group rolls up its assertion count, failure count and
+   * wall time (children included) from shard snapshots, so one pass over the
+   * data yields the full per-group attribution without reset-and-rerun.
+   * The stack is preallocated; groups nested deeper than GROUP_STACK_DEPTH
+   * are tracked for begin/end symmetry but not recorded. Grouping is
+   * driver-side state: call begin/end from the coordinating thread. */
+  void begin_group(int group_id) {
+    if (group_depth >= GROUP_STACK_DEPTH) {
+      ++group_overflow_depth;
+      return;
+    }
+
+    GroupFrame &frame = group_stack[group_depth];
+    frame.record_index = group_records.size();
+    frame.start_assertion_count = assertion_count();
+    frame.start_failure_count = failure_count();
+    frame.start_time = std::chrono::steady_clock::now();
+
+    GroupRecord record;
+    record.id = group_id;
+    record.depth = group_depth;
+    record.open = true;
+    record.assertion_count = 0;
+    record.failure_count = 0;
+    record.elapsed_ms = 0.0;
+    group_records.push_back(record);
+
+    ++group_depth;
+  }
+
+  void end_group() {
+    if (group_overflow_depth > 0) {
+      --group_overflow_depth;
+      return;
+    }
+    if (group_depth == 0) {
+      return;
+    }
+
+    --group_depth;
+    const GroupFrame &frame = group_stack[group_depth];
+    GroupRecord &record = group_records[frame.record_index];
+    record.open = false;
+    record.assertion_count = assertion_count() - frame.start_assertion_count;
+    record.failure_count = failure_count() - frame.start_failure_count;
+    record.elapsed_ms =
+        std::chrono::duration_cast<
+            std::chrono::duration<double, std::milli>>(
+            std::chrono::steady_clock::now() - frame.start_time)
+            .count();
+  }
+
+  /* Prints one line per group in begin order, indented by nesting depth. */
+  void dump_group_report() {
+    std::ostringstream report;
+    report << "=== MCAPTester group report ===\n";
+    for (std::size_t i = 0; i < group_records.size(); i++) {
+      const GroupRecord &record = group_records[i];
+      for (std::size_t d = 0; d < record.depth; d++) {
+        report << "  ";
+      }
+      report << "group " << record.id << ": "
+             << ((record.failure_count == 0) ? "PASS" : "FAIL")
+             << " assertions=" << record.assertion_count
+             << " failures=" << record.failure_count;
+      if (record.open) {
+        report << " (still open)";
+      } else {
+        report << " time_ms=" << record.elapsed_ms;
+      }
+      report << "\n";
+    }
+
+    std::cout << report.str() << std::flush;
+  }
+
+private:
+  struct FailureRecord {
+    std::size_t message_offset;
+    std::size_t message_length;
+    int message_id;
+    const char *detail;
+    std::size_t row;
+    std::size_t column;
+    T actual_value;
+    T expected_value;
+  };
+
+  /* Per-thread slice of the failure state. Each shard is cache-line aligned
+   * so concurrent expect_near calls on different threads never false-share a
+   * line; the shards are only merged when the caller asks for totals or in
+   * throw_error_if_test_failed(). Threads map onto shards by thread-id hash,
+   * so two threads may share one shard; the atomics and the per-shard log
+   * lock keep that safe. */
+  struct alignas(64) Shard {
+    Shard() : failed(false), fail_count(0), assertion_count(0),
+              max_error(static_cast<T>(0)), log_lock(false),
+              dropped_failure_count(0) {}
+
+    void update_max(T candidate) {
+      T current = max_error.load(std::memory_order_relaxed);
+      while ((candidate > current) &&
+             (!max_error.compare_exchange_weak(current, candidate,
+                                               std::memory_order_relaxed))) {
+        /* Do Nothing. */
+      }
+    }
+
+    std::atomic<bool> failed;
+    std::atomic<std::size_t> fail_count;
+    std::atomic<std::size_t> assertion_count;
+    std::atomic<T> max_error;
+    std::atomic<bool> log_lock;
+    std::size_t dropped_failure_count;
+    std::vector<FailureRecord> failure_log;
+    std::vector<char> message_arena;
+  };
+
+  /* Spinlock guard for a shard's failure log; only ever contended on the
+   * failure path when two threads hash to the same shard. */
+  struct ShardLogGuard {
+    explicit ShardLogGuard(Shard &shard_in) : shard(shard_in) {
+      while (shard.log_lock.exchange(true, std::memory_order_acquire)) {
+        /* Do Nothing. */
+      }
+    }
+
+    ~ShardLogGuard() { shard.log_lock.store(false, std::memory_order_release); }
+
+    Shard &shard;
+  };
+
+  Shard &current_shard() {
+    static thread_local const std::size_t index =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % SHARD_COUNT;
+    return shards[index];
+  }
+
+  void bump_failure_count(std::size_t count) {
+    Shard &shard = current_shard();
+    shard.failed.store(true, std::memory_order_relaxed);
+    shard.fail_count.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  void note_assertion(std::size_t count) {
+    current_shard().assertion_count.fetch_add(count,
+                                              std::memory_order_relaxed);
+  }
+
+  void update_max_error(T candidate) { current_shard().update_max(candidate); }
+
+  /* Overflow-safe absolute difference: integral element types form the
+   * difference in the unsigned domain (saturated back to T for reporting),
+   * floating-point types use plain std::abs. */
+  template <typename U = T>
+  static typename std::enable_if<std::is_integral<U>::value, T>::type
+  abs_difference(T a, T b) {
+    typedef typename std::make_unsigned<T>::type Unsigned;
+    Unsigned difference = Kernel::integer_abs_diff(a, b);
+    Unsigned type_max = static_cast<Unsigned>((std::numeric_limits<T>::max)());
+    return static_cast<T>(
+        (difference > type_max) ? type_max : difference);
+  }
+
+  template <typename U = T>
+  static typename std::enable_if<!std::is_integral<U>::value, T>::type
+  abs_difference(T a, T b) {
+    return std::abs(a - b);
+  }
+
+  /* Failure-path detail strings. These run only once a pair has already
+   * failed, so the NaN/Inf classification adds nothing to the hot sweep. */
+  static const char *non_finite_detail(T actual, T expected) {
+    if (Kernel::is_nan_value(actual) || Kernel::is_nan_value(expected)) {
+      return "NaN value.";
+    }
+    if (Kernel::is_inf_value(actual) || Kernel::is_inf_value(expected)) {
+      return "Infinite value.";
+    }
+    return "";
+  }
+
+  static const char *mismatch_detail(T actual, T expected) {
+    const char *detail = non_finite_detail(actual, expected);
+    return (detail[0] != '\0') ? detail : "Element mismatch.";
+  }
+
+  void expect_near_scalar(T actual, T expected, T tolerance,
+                          const MessageRef &message) {
+    MCAP_TESTER_PROFILE_SCOPE(message, 1);
+    note_assertion(1);
+    if (scan_policy == ScanPolicy::CountAll) {
+      update_max_error(abs_difference(actual, expected));
+    }
+
+    if (run_first_mismatch(&actual, &expected, 1, tolerance) == 0) {
+      bump_failure_count(1);
+      record_failure(message, non_finite_detail(actual, expected), 0, 0,
+                     actual, expected);
+    }
+  }
+
+  void expect_near_span(Span<T> actual, Span<T> expected, T tolerance,
+                        const MessageRef &message) {
+    MCAP_TESTER_PROFILE_SCOPE(message, actual.size());
+    note_assertion(1);
+    if (actual.size() != expected.size()) {
+      bump_failure_count(1);
+      record_failure(message, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+
+    if (comparison_cache_enabled && (message.id >= 0)) {
+      std::uint64_t digest = digest_comparison(
+          actual.data(), expected.data(), actual.size(), tolerance);
+      if (cache_holds_pass(message.id, digest)) {
+        comparison_cache_hit_count++;
+        return;
+      }
+
+      bool failed = compare_contiguous(actual.data(), expected.data(),
+                                       actual.size(), tolerance, message, 0,
+                                       0, 0);
+      if (!failed) {
+        cache_store_pass(message.id, digest);
+      }
+      return;
+    }
+
+    compare_contiguous(actual.data(), expected.data(), actual.size(),
+                       tolerance, message, 0, 0, 0);
+  }
+
+  /* Core behind the tolerance-profile overloads. The profile picks the
+   * sweep at compile time through the enable_if pair below. */
+  template <typename Profile>
+  void expect_near_profiled(Span<T> actual, Span<T> expected,
+                            const MessageRef &message) {
+    MCAP_TESTER_PROFILE_SCOPE(message, actual.size());
+    note_assertion(1);
+    if (actual.size() != expected.size()) {
+      bump_failure_count(1);
+      record_failure(message, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+
+    compare_profiled<Profile>(actual.data(), expected.data(), actual.size(),
+                              message);
+  }
+
+  /* Bitwise profile: the bulk compare is one memcmp over the raw bytes, so
+   * no tolerance arithmetic runs at all. Under CountAll the max-error rollup
+   * keeps only the first differing pair; exact assertions care about
+   * equality, not magnitude. */
+  template <typename Profile>
+  typename std::enable_if<Profile::bitwise>::type
+  compare_profiled(const T *actual, const T *expected, std::size_t size,
+                   const MessageRef &message) {
+    if (scan_policy == ScanPolicy::CountAll) {
+      std::size_t fail_count =
+          Kernel::count_mismatch_exact(actual, expected, size);
+      if (fail_count == 0) {
+        return;
+      }
+
+      bump_failure_count(fail_count);
+      std::size_t index = Kernel::first_mismatch_exact(actual, expected, size);
+      update_max_error(abs_difference(actual[index], expected[index]));
+      record_failure(message, mismatch_detail(actual[index], expected[index]),
+                     0, index, actual[index], expected[index]);
+      return;
+    }
+
+    std::size_t index = Kernel::first_mismatch_exact(actual, expected, size);
+    if (index < size) {
+      bump_failure_count(1);
+      record_failure(message, mismatch_detail(actual[index], expected[index]),
+                     0, index, actual[index], expected[index]);
+    }
+  }
+
+  /* Static-tolerance profile: the constant folds into the regular mode
+   * dispatch, so the inlined kernel compares against an immediate instead of
+   * a loaded argument. */
+  template <typename Profile>
+  typename std::enable_if<!Profile::bitwise>::type
+  compare_profiled(const T *actual, const T *expected, std::size_t size,
+                   const MessageRef &message) {
+    compare_contiguous(actual, expected, size,
+                       Profile::template tolerance<T>(), message, 0, 0, 0);
+  }
+
+  void expect_near_span2d(Span2D<T> actual, Span2D<T> expected, T tolerance,
+                          const MessageRef &message) {
+    MCAP_TESTER_PROFILE_SCOPE(message, actual.size());
+    note_assertion(1);
+    if ((actual.rows() != expected.rows()) ||
+        (actual.columns() != expected.columns())) {
+      bump_failure_count(1);
+      record_failure(message, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+
+    if (comparison_cache_enabled && (message.id >= 0)) {
+      std::uint64_t digest = digest_comparison(
+          actual.data(), expected.data(), actual.size(), tolerance);
+      if (cache_holds_pass(message.id, digest)) {
+        comparison_cache_hit_count++;
+        return;
+      }
+
+      bool failed = compare_contiguous(actual.data(), expected.data(),
+                                       actual.size(), tolerance, message, 0,
+                                       actual.columns(), 0);
+      if (!failed) {
+        cache_store_pass(message.id, digest);
+      }
+      return;
+    }
+
+    compare_contiguous(actual.data(), expected.data(), actual.size(),
+                       tolerance, message, 0, actual.columns(), 0);
+  }
+
+  template <typename U = T>
+  typename std::enable_if<std::is_floating_point<U>::value, std::size_t>::type
+  ulp_first_mismatch(const T *actual, const T *expected, std::size_t size,
+                     T tolerance) {
+    return Kernel::first_mismatch_ulp(
+        actual, expected, size, static_cast<std::uint64_t>(tolerance));
+  }
+
+  template <typename U = T>
+  typename std::enable_if<!std::is_floating_point<U>::value,
+                          std::size_t>::type
+  ulp_first_mismatch(const T *actual, const T *expected, std::size_t size,
+                     T tolerance) {
+    return Kernel::first_mismatch(actual, expected, size, tolerance);
+  }
+
+  template <typename U = T>
+  typename std::enable_if<std::is_floating_point<U>::value, std::size_t>::type
+  ulp_count_mismatch(const T *actual, const T *expected, std::size_t size,
+                     T tolerance, T *max_error) {
+    return Kernel::count_mismatch_ulp(actual, expected, size,
+                                      static_cast<std::uint64_t>(tolerance),
+                                      max_error);
+  }
+
+  template <typename U = T>
+  typename std::enable_if<!std::is_floating_point<U>::value,
+                          std::size_t>::type
+  ulp_count_mismatch(const T *actual, const T *expected, std::size_t size,
+                     T tolerance, T *max_error) {
+    return Kernel::count_mismatch(actual, expected, size, tolerance,
+                                  max_error);
+  }
+
+#if defined(MCAP_TESTER_USE_DISPATCH)
+  /* Absolute-mode kernels routed through the runtime CPU-dispatch table.
+   * The float/double overloads hit the per-ISA variants from the dispatch
+   * library; every other element type keeps the header kernel. */
+  static std::size_t dispatched_first_mismatch(const float *actual,
+                                               const float *expected,
+                                               std::size_t size,
+                                               float tolerance) {
+    return Dispatch::first_mismatch(actual, expected, size, tolerance);
+  }
+
+  static std::size_t dispatched_first_mismatch(const double *actual,
+                                               const double *expected,
+                                               std::size_t size,
+                                               double tolerance) {
+    return Dispatch::first_mismatch(actual, expected, size, tolerance);
+  }
+
+  template <typename U>
+  static std::size_t dispatched_first_mismatch(const U *actual,
+                                               const U *expected,
+                                               std::size_t size, U tolerance) {
+    return Kernel::first_mismatch(actual, expected, size, tolerance);
+  }
+
+  static std::size_t dispatched_count_mismatch(const float *actual,
+                                               const float *expected,
+                                               std::size_t size,
+                                               float tolerance,
+                                               float *max_error) {
+    return Dispatch::count_mismatch(actual, expected, size, tolerance,
+                                    max_error);
+  }
+
+  static std::size_t dispatched_count_mismatch(const double *actual,
+                                               const double *expected,
+                                               std::size_t size,
+                                               double tolerance,
+                                               double *max_error) {
+    return Dispatch::count_mismatch(actual, expected, size, tolerance,
+                                    max_error);
+  }
+
+  template <typename U>
+  static std::size_t dispatched_count_mismatch(const U *actual,
+                                               const U *expected,
+                                               std::size_t size, U tolerance,
+                                               U *max_error) {
+    return Kernel::count_mismatch(actual, expected, size, tolerance,
+                                  max_error);
+  }
+#endif
+
+  /* Mode dispatch for the contiguous kernels. */
+  std::size_t run_first_mismatch(const T *actual, const T *expected,
+                                 std::size_t size, T tolerance) {
+    switch (comparison_mode) {
+    case ComparisonMode::Relative:
+      return Kernel::first_mismatch_relative(actual, expected, size,
+                                             tolerance);
+    case ComparisonMode::Ulp:
+      return ulp_first_mismatch(actual, expected, size, tolerance);
+    default:
+#if defined(MCAP_TESTER_USE_DISPATCH)
+      return dispatched_first_mismatch(actual, expected, size, tolerance);
+#else
+      return Kernel::first_mismatch(actual, expected, size, tolerance);
+#endif
+    }
+  }
+
+  std::size_t run_count_mismatch(const T *actual, const T *expected,
+                                 std::size_t size, T tolerance,
+                                 T *max_error) {
+    switch (comparison_mode) {
+    case ComparisonMode::Relative:
+      return Kernel::count_mismatch_relative(actual, expected, size, tolerance,
+                                             max_error);
+    case ComparisonMode::Ulp:
+      return ulp_count_mismatch(actual, expected, size, tolerance, max_error);
+    default:
+#if defined(MCAP_TESTER_USE_DISPATCH)
+      return dispatched_count_mismatch(actual, expected, size, tolerance,
+                                       max_error);
+#else
+      return Kernel::count_mismatch(actual, expected, size, tolerance,
+                                    max_error);
+#endif
+    }
+  }
+
+  /* Shared contiguous sweep behind the 1D and row-wise overloads. "columns"
+   * is non-zero when the range is a row-major 2D buffer, in which case the
+   * failing index is split into (row, column); otherwise "row_base" names the
+   * row the range belongs to and "column_base" is the column offset of the
+   * range within that row (non-zero for blocked tiles). Returns true when
+   * the range failed. */
+  bool compare_contiguous(const T *actual, const T *expected, std::size_t size,
+                          T tolerance, const MessageRef &message,
+                          std::size_t row_base, std::size_t columns,
+                          std::size_t column_base) {
+    if (comparison_statistics_enabled) {
+      return compare_contiguous_stats(actual, expected, size, tolerance,
+                                      message, row_base, columns, column_base);
+    }
+
+    if (scan_policy == ScanPolicy::CountAll) {
+      T max_difference = static_cast<T>(0);
+      std::size_t fail_count = run_count_mismatch(actual, expected, size,
+                                                  tolerance, &max_difference);
+      update_max_error(max_difference);
+      if (fail_count == 0) {
+        return false;
+      }
+
+      bump_failure_count(fail_count);
+      std::size_t index =
+          run_first_mismatch(actual, expected, size, tolerance);
+      if (columns > 0) {
+        record_failure(message, mismatch_detail(actual[index],
+                                              expected[index]),
+                       index / columns, index % columns, actual[index],
+                       expected[index]);
+      } else {
+        record_failure(message, mismatch_detail(actual[index],
+                                              expected[index]),
+                       row_base, column_base + index, actual[index],
+                       expected[index]);
+      }
+      return true;
+    }
+
+    std::size_t index =
+        run_first_mismatch(actual, expected, size, tolerance);
+    if (index < size) {
+      bump_failure_count(1);
+      if (columns > 0) {
+        record_failure(message, mismatch_detail(actual[index],
+                                              expected[index]),
+                       index / columns, index % columns, actual[index],
+                       expected[index]);
+      } else {
+        record_failure(message, mismatch_detail(actual[index],
+                                              expected[index]),
+                       row_base, column_base + index, actual[index],
+                       expected[index]);
+      }
+      return true;
+    }
+
+    return false;
+  }
+
+  /* Statistics variant of the contiguous sweep: one fused kernel pass does
+   * the tolerance check and fills the max/mean/RMS accumulators, then the
+   * result is latched for last_comparison_stats(). Failure reporting matches
+   * compare_contiguous; the locate pass only runs on the failure path. */
+  bool compare_contiguous_stats(const T *actual, const T *expected,
+                                std::size_t size, T tolerance,
+                                const MessageRef &message,
+                                std::size_t row_base, std::size_t columns,
+                                std::size_t column_base) {
+    double max_difference = 0.0;
+    double sum_error = 0.0;
+    double sum_squared_error = 0.0;
+    std::size_t fail_count =
+        Kernel::count_mismatch_stats(actual, expected, size, tolerance,
+                                     &max_difference, &sum_error,
+                                     &sum_squared_error);
+
+    last_stats.max_error = max_difference;
+    last_stats.mean_error =
+        (size > 0) ? (sum_error / static_cast<double>(size)) : 0.0;
+    last_stats.rms_error =
+        (size > 0) ? std::sqrt(sum_squared_error / static_cast<double>(size))
+                   : 0.0;
+    last_stats.element_count = size;
+
+    if (scan_policy == ScanPolicy::CountAll) {
+      update_max_error(static_cast<T>(max_difference));
+    }
+    if (fail_count == 0) {
+      return false;
+    }
+
+    bump_failure_count(
+        (scan_policy == ScanPolicy::CountAll) ? fail_count : 1);
+    std::size_t index = Kernel::first_mismatch(actual, expected, size,
+                                               tolerance);
+    if (columns > 0) {
+      record_failure(message, mismatch_detail(actual[index], expected[index]),
+                     index / columns, index % columns, actual[index],
+                     expected[index]);
+    } else {
+      record_failure(message, mismatch_detail(actual[index], expected[index]),
+                     row_base, column_base + index, actual[index],
+                     expected[index]);
+    }
+    return true;
+  }
+
+  /* Fixed-size counterpart of compare_contiguous. Small N compiles down to
+   * straight-line compares through the unrolled kernel. */
+  template <std::size_t N>
+  bool compare_fixed(const T *actual, const T *expected, T tolerance,
+                     const MessageRef &message, std::size_t row_base) {
+    if (scan_policy == ScanPolicy::CountAll) {
+      return compare_contiguous(actual, expected, N, tolerance, message,
+                                row_base, 0, 0);
+    }
+
+    std::size_t index =
+        (comparison_mode == ComparisonMode::Absolute)
+            ? Kernel::first_mismatch_fixed<N>(actual, expected, tolerance)
+            : run_first_mismatch(actual, expected, N, tolerance);
+    if (index < N) {
+      bump_failure_count(1);
+      record_failure(message, mismatch_detail(actual[index], expected[index]),
+                     row_base, index, actual[index], expected[index]);
+      return true;
+    }
+
+    return false;
+  }
+
+  /* Range core behind the iterator-pair overloads. The pointer-iterator
+   * specialization forwards to the contiguous Span path; the generic one
+   * walks the ranges element-wise, deciding each pair through the same
+   * scan-policy/comparison-mode dispatch as the contiguous kernels. */
+  template <typename Iterator>
+  typename std::enable_if<std::is_pointer<Iterator>::value>::type
+  expect_near_range(Iterator actual_begin, Iterator actual_end,
+                    Iterator expected_begin, Iterator expected_end,
+                    T tolerance, const MessageRef &message) {
+    if ((actual_end - actual_begin) != (expected_end - expected_begin)) {
+      note_assertion(1);
+      bump_failure_count(1);
+      record_failure(message, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+
+    expect_near_span(
+        Span<T>(actual_begin,
+                static_cast<std::size_t>(actual_end - actual_begin)),
+        Span<T>(expected_begin,
+                static_cast<std::size_t>(expected_end - expected_begin)),
+        tolerance, message);
+  }
+
+  template <typename Iterator>
+  typename std::enable_if<!std::is_pointer<Iterator>::value>::type
+  expect_near_range(Iterator actual_begin, Iterator actual_end,
+                    Iterator expected_begin, Iterator expected_end,
+                    T tolerance, const MessageRef &message) {
+    note_assertion(1);
+    if (std::distance(actual_begin, actual_end) !=
+        std::distance(expected_begin, expected_end)) {
+      bump_failure_count(1);
+      record_failure(message, "Size mismatch.", 0, 0, static_cast<T>(0),
+                     static_cast<T>(0));
+      return;
+    }
+
+    MCAP_TESTER_PROFILE_SCOPE(
+        message,
+        static_cast<std::size_t>(std::distance(actual_begin, actual_end)));
+
+    std::size_t index = 0;
+    std::size_t fail_count = 0;
+    T max_difference = static_cast<T>(0);
+    std::size_t first_fail_index = 0;
+    T first_fail_actual = static_cast<T>(0);
+    T first_fail_expected = static_cast<T>(0);
+
+    Iterator expected_it = expected_begin;
+    for (Iterator actual_it = actual_begin; actual_it != actual_end;
+         ++actual_it, ++expected_it, ++index) {
+      T actual_value = static_cast<T>(*actual_it);
+      T expected_value = static_cast<T>(*expected_it);
+      if (scan_policy == ScanPolicy::CountAll) {
+        T difference = abs_difference(actual_value, expected_value);
+        max_difference =
+            (difference > max_difference) ? difference : max_difference;
+      }
+      if (run_first_mismatch(&actual_value, &expected_value, 1, tolerance) !=
+          0) {
+        continue;
+      }
+
+      if (scan_policy == ScanPolicy::FirstFailure) {
+        bump_failure_count(1);
+        record_failure(message, mismatch_detail(actual_value, expected_value),
+                       0, index, actual_value, expected_value);
+        return;
+      }
+
+      if (fail_count == 0) {
+        first_fail_index = index;
+        first_fail_actual = actual_value;
+        first_fail_expected = expected_value;
+      }
+      fail_count++;
+    }
+
+    if (scan_policy == ScanPolicy::CountAll) {
+      update_max_error(max_difference);
+      if (fail_count > 0) {
+        bump_failure_count(fail_count);
+        record_failure(message,
+                       mismatch_detail(first_fail_actual,
+                                       first_fail_expected),
+                       0, first_fail_index, first_fail_actual,
+                       first_fail_expected);
+      }
+    }
+  }
+
+  /* Single-pass mixed-precision sweep behind the heterogeneous overloads.
+   * Diagnostics (recorded values and the max-error rollup) are narrowed to
+   * T after the comparison has already been decided in the common type. */
+  template <typename ActualT, typename ExpectedT>
+  void expect_near_mixed_contiguous(const ActualT *actual,
+                                    const ExpectedT *expected,
+                                    std::size_t size, T tolerance,
+                                    const MessageRef &message) {
+    typedef typename std::common_type<ActualT, ExpectedT>::type Common;
+    MCAP_TESTER_PROFILE_SCOPE(message, size);
+    note_assertion(1);
+
+    if (scan_policy == ScanPolicy::CountAll) {
+      Common max_difference = static_cast<Common>(0);
+      std::size_t fail_count = Kernel::count_mismatch_mixed(
+          actual, expected, size, static_cast<Common>(tolerance),
+          &max_difference);
+      update_max_error(static_cast<T>(max_difference));
+      if (fail_count == 0) {
+        return;
+      }
+
+      bump_failure_count(fail_count);
+      std::size_t index = Kernel::first_mismatch_mixed(
+          actual, expected, size, static_cast<Common>(tolerance));
+      record_failure(message,
+                     mismatch_detail(static_cast<T>(actual[index]),
+                                     static_cast<T>(expected[index])),
+                     0, index, static_cast<T>(actual[index]),
+                     static_cast<T>(expected[index]));
+      return;
+    }
+
+    std::size_t index = Kernel::first_mismatch_mixed(
+        actual, expected, size, static_cast<Common>(tolerance));
+    if (index < size) {
+      bump_failure_count(1);
+      record_failure(message,
+                     mismatch_detail(static_cast<T>(actual[index]),
+                                     static_cast<T>(expected[index])),
+                     0, index, static_cast<T>(actual[index]),
+                     static_cast<T>(expected[index]));
+    }
+  }
+
+  /* Cache-blocked 2D sweep: corresponding tiles of actual and expected are
+   * walked together so both operands of a tile stay resident in L1 instead
+   * of streaming through cache against each other. Tile size is picked so
+   * one tile of each operand fits in half of a 32 KiB L1d with double
+   * elements. Failures are found in tile order rather than strict row-major
+   * order; the counts and the max-error rollup are unaffected. Rows must be
+   * uniform (callers check). Returns true when any tile failed. */
+  template <typename RowContainer>
+  bool compare_rows_blocked(const RowContainer &actual,
+                            const RowContainer &expected, T tolerance,
+                            const MessageRef &message) {
+    const std::size_t rows = actual.size();
+    const std::size_t columns = actual[0].size();
+    bool any_failed = false;
+
+    for (std::size_t row_base = 0; row_base < rows;
+         row_base += BLOCK_TILE_ROWS) {
+      std::size_t row_end = row_base + BLOCK_TILE_ROWS;
+      row_end = (row_end < rows) ? row_end : rows;
+
+      for (std::size_t column_base = 0; column_base < columns;
+           column_base += BLOCK_TILE_COLUMNS) {
+        std::size_t tile_columns = columns - column_base;
+        tile_columns = (tile_columns < BLOCK_TILE_COLUMNS) ? tile_columns
+                                                           : BLOCK_TILE_COLUMNS;
+
+        for (std::size_t i = row_base; i < row_end; i++) {
+          bool segment_failed = compare_contiguous(
+              actual[i].data() + column_base,
+              expected[i].data() + column_base, tile_columns, tolerance,
+              message, i, 0, column_base);
+          if (segment_failed) {
+            if (scan_policy == ScanPolicy::FirstFailure) {
+              return true;
+            }
+            any_failed = true;
+          }
+        }
+      }
+    }
+
+    return any_failed;
+  }
+
+  /* Comparison-cache internals. Entries key on the message id and live in a
+   * fixed open-addressed table probed like the profile table; an insert that
+   * finds no free slot within the probe limit simply does not cache. */
+  std::uint64_t digest_comparison(const T *actual, const T *expected,
+                                  std::size_t size, T tolerance) const {
+    static const std::uint64_t FNV_BASIS = 0xCBF29CE484222325ULL;
+    std::uint64_t digest = FNV_BASIS;
+    digest = Kernel::digest_bytes(&tolerance, sizeof(tolerance), digest);
+    unsigned char settings[2];
+    settings[0] = static_cast<unsigned char>(scan_policy);
+    settings[1] = static_cast<unsigned char>(comparison_mode);
+    digest = Kernel::digest_bytes(settings, sizeof(settings), digest);
+    digest = Kernel::digest_bytes(actual, size * sizeof(T), digest);
+    digest = Kernel::digest_bytes(expected, size * sizeof(T), digest);
+    return digest;
+  }
+
+  bool cache_holds_pass(int message_id, std::uint64_t digest) const {
+    std::size_t slot_index =
+        static_cast<std::size_t>(message_id) % COMPARISON_CACHE_SIZE;
+    for (std::size_t probe = 0; probe < COMPARISON_CACHE_PROBE_LIMIT;
+         probe++) {
+      const CacheSlot &slot =
+          comparison_cache[(slot_index + probe) % COMPARISON_CACHE_SIZE];
+      if (!slot.used) {
+        return false;
+      }
+      if (slot.message_id == message_id) {
+        return slot.digest == digest;
+      }
+    }
+    return false;
+  }
+
+  void cache_store_pass(int message_id, std::uint64_t digest) {
+    std::size_t slot_index =
+        static_cast<std::size_t>(message_id) % COMPARISON_CACHE_SIZE;
+    for (std::size_t probe = 0; probe < COMPARISON_CACHE_PROBE_LIMIT;
+         probe++) {
+      CacheSlot &slot =
+          comparison_cache[(slot_index + probe) % COMPARISON_CACHE_SIZE];
+      if (!slot.used || (slot.message_id == message_id)) {
+        slot.used = true;
+        slot.message_id = message_id;
+        slot.digest = digest;
+        return;
+      }
+    }
+    /* Do Nothing: table region is full, this assertion stays uncached. */
+  }
+
+  /* Bump-copies the message text into the shard's preallocated arena so a
+   * deferred record never owns heap memory of its own. Returns the stored
+   * length, which is zero when the arena is out of space (the id still
+   * identifies the assertion in that case). */
+  static std::size_t arena_store(Shard &shard, const MessageRef &message) {
+    if ((shard.message_arena.size() + message.length) >
+        shard.message_arena.capacity()) {
+      return 0;
+    }
+    shard.message_arena.insert(shard.message_arena.end(), message.text,
+                               message.text + message.length);
+    return message.length;
+  }
+
+  /* Maps the interned detail strings onto the fixed report codes; anything
+   * unrecognized degrades to a plain element mismatch. */
+  static std::uint32_t detail_to_code(const char *detail) {
+    if (detail[0] == '\0') {
+      return Report::DetailNone;
+    }
+    if (std::strcmp(detail, "Size mismatch.") == 0) {
+      return Report::DetailSizeMismatch;
+    }
+    if (std::strcmp(detail, "NaN value.") == 0) {
+      return Report::DetailNaN;
+    }
+    if (std::strcmp(detail, "Infinite value.") == 0) {
+      return Report::DetailInfinite;
+    }
+    if (std::strcmp(detail, "Golden file error.") == 0) {
+      return Report::DetailGoldenFileError;
+    }
+    return Report::DetailElementMismatch;
+  }
+
+  /* Size mismatches and golden-file errors carry no element values, so the
+   * value/position tail is skipped for them. */
+  static bool detail_has_values(const char *detail) {
+    return (std::strcmp(detail, "Size mismatch.") != 0) &&
+           (std::strcmp(detail, "Golden file error.") != 0);
+  }
+
+  /* Appends the triage fields the comparison pass already captured: failing
+   * position, both values and the absolute error. One failing sweep then
+   * yields everything regression localization needs, with no instrumented
+   * rerun. */
+  static void write_failure_values(std::ostream &out, const char *detail,
+                                   std::size_t row, std::size_t column,
+                                   T actual_value, T expected_value) {
+    if (detail[0] != '\0') {
+      out << " " << detail;
+    }
+    if (!detail_has_values(detail)) {
+      return;
+    }
+
+    const std::streamsize saved_precision = out.precision();
+    if (std::numeric_limits<T>::max_digits10 > 0) {
+      out.precision(std::numeric_limits<T>::max_digits10);
+    }
+    out << " at (" << row << ", " << column << ") actual=" << actual_value
+        << " expected=" << expected_value
+        << " error=" << abs_difference(actual_value, expected_value);
+    out.precision(saved_precision);
+  }
+
+  void record_failure(const MessageRef &message, const char *detail,
+                      std::size_t row, std::size_t column, T actual_value,
+                      T expected_value) {
+    Shard &shard = current_shard();
+    shard.failed.store(true, std::memory_order_relaxed);
+
+    if (deferred_reporting_enabled) {
+      ShardLogGuard guard(shard);
+      if (shard.failure_log.size() < shard.failure_log.capacity()) {
+        FailureRecord record;
+        record.message_offset = shard.message_arena.size();
+        record.message_length = arena_store(shard, message);
+        record.message_id = message.id;
+        record.detail = detail;
+        record.row = row;
+        record.column = column;
+        record.actual_value = actual_value;
+        record.expected_value = expected_value;
+        shard.failure_log.push_back(record);
+      } else {
+        shard.dropped_failure_count++;
+      }
+    } else {
+      std::cout << "FAILURE: ";
+      std::cout.write(message.text,
+                      static_cast<std::streamsize>(message.length));
+      if (message.id >= 0) {
+        std::cout << " [id " << message.id << "]";
+      }
+      write_failure_values(std::cout, detail, row, column, actual_value,
+                           expected_value);
+      std::cout << std::endl;
+      std::cout << std::endl;
+    }
+  }
+
+  void flush_failure_log(void) {
+    std::ostringstream report;
+    bool any_output = false;
+    std::size_t dropped_total = 0;
+
+    for (std::size_t s = 0; s < SHARD_COUNT; s++) {
+      Shard &shard = shards[s];
+      ShardLogGuard guard(shard);
+      for (std::size_t i = 0; i < shard.failure_log.size(); i++) {
+        const FailureRecord &record = shard.failure_log[i];
+        any_output = true;
+        report << "FAILURE: ";
+        if (record.message_length > 0) {
+          report.write(&shard.message_arena[record.message_offset],
+                       static_cast<std::streamsize>(record.message_length));
+        }
+        if (record.message_id >= 0) {
+          report << " [id " << record.message_id << "]";
+        }
+        write_failure_values(report, record.detail, record.row, record.column,
+                             record.actual_value, record.expected_value);
+        report << "\n\n";
+      }
+      dropped_total += shard.dropped_failure_count;
+      shard.failure_log.clear();
+      shard.message_arena.clear();
+      shard.dropped_failure_count = 0;
+    }
+
+    if (dropped_total > 0) {
+      any_output = true;
+      report << "NOTE: " << dropped_total
+             << " additional failures were not recorded (log full).\n\n";
+    }
+
+    if (any_output) {
+      std::cout << report.str() << std::flush;
+    }
+  }
+
+#if defined(MCAP_TESTER_ENABLE_PROFILING)
+  static const std::size_t PROFILE_TABLE_SIZE = 256;
+  static const std::size_t PROFILE_HISTOGRAM_BUCKETS = 32;
+  static const std::size_t PROFILE_LABEL_SIZE = 48;
+  static const std::size_t PROFILE_PROBE_LIMIT = 8;
+
+  struct ProfileSlot {
+    bool used;
+    std::size_t message_hash;
+    char label[PROFILE_LABEL_SIZE];
+    std::size_t call_count;
+    std::size_t element_total;
+    unsigned long long total_ns;
+    unsigned long long min_ns;
+    unsigned long long max_ns;
+    std::size_t latency_histogram[PROFILE_HISTOGRAM_BUCKETS];
+  };
+
+  /* Times one assertion with a steady_clock read on entry and exit and folds
+   * the sample into the fixed profile table on destruction. */
+  struct ProfileScope {
+    ProfileScope(MCAPTester *owner_in, const MessageRef &message_in,
+                 std::size_t element_count_in)
+        : owner(owner_in), message(message_in),
+          element_count(element_count_in),
+          start_time(std::chrono::steady_clock::now()) {}
+
+    ~ProfileScope() {
+      unsigned long long elapsed_ns = static_cast<unsigned long long>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start_time)
+              .count());
+      owner->profile_record(message, element_count, elapsed_ns);
+    }
+
+    MCAPTester *owner;
+    MessageRef message;
+    std::size_t element_count;
+    std::chrono::steady_clock::time_point start_time;
+  };
+
+  static std::size_t profile_hash(const MessageRef &message) {
+    std::size_t hash = static_cast<std::size_t>(1469598103934665603ULL);
+    for (std::size_t i = 0; i < message.length; i++) {
+      hash ^= static_cast<std::size_t>(
+          static_cast<unsigned char>(message.text[i]));
+      hash *= static_cast<std::size_t>(1099511628211ULL);
+    }
+    return hash;
+  }
+
+  void profile_record(const MessageRef &message, std::size_t element_count,
+                      unsigned long long elapsed_ns) {
+    std::size_t hash = profile_hash(message);
+    for (std::size_t probe = 0; probe < PROFILE_PROBE_LIMIT; probe++) {
+      ProfileSlot &slot =
+          profile_table[(hash + probe) % PROFILE_TABLE_SIZE];
+      if (slot.used && (slot.message_hash != hash)) {
+        continue;
+      }
+
+      if (!slot.used) {
+        slot.used = true;
+        slot.message_hash = hash;
+        std::size_t label_length = (message.length < (PROFILE_LABEL_SIZE - 1))
+                                       ? message.length
+                                       : (PROFILE_LABEL_SIZE - 1);
+        std::memcpy(slot.label, message.text, label_length);
+        slot.label[label_length] = '\0';
+        slot.min_ns = elapsed_ns;
+        slot.max_ns = elapsed_ns;
+      }
+
+      slot.call_count++;
+      slot.element_total += element_count;
+      slot.total_ns += elapsed_ns;
+      slot.min_ns = (elapsed_ns < slot.min_ns) ? elapsed_ns : slot.min_ns;
+      slot.max_ns = (elapsed_ns > slot.max_ns) ? elapsed_ns : slot.max_ns;
+
+      std::size_t bucket = 0;
+      unsigned long long remaining = elapsed_ns;
+      while ((remaining >>= 1) != 0ULL) {
+        bucket++;
+      }
+      bucket = (bucket < PROFILE_HISTOGRAM_BUCKETS)
+                   ? bucket
+                   : (PROFILE_HISTOGRAM_BUCKETS - 1);
+      slot.latency_histogram[bucket]++;
+      return;
+    }
+
+    profile_overflow_count++;
+  }
+#endif
+
+  /* One stack frame per open group; rollups are computed from shard
+   * snapshots taken at begin_group() time. */
+  struct GroupFrame {
+    std::size_t record_index;
+    std::size_t start_assertion_count;
+    std::size_t start_failure_count;
+    std::chrono::steady_clock::time_point start_time;
+  };
+
+  struct GroupRecord {
+    int id;
+    std::size_t depth;
+    bool open;
+    std::size_t assertion_count;
+    std::size_t failure_count;
+    double elapsed_ms;
+  };
+
+  static const std::size_t DEFAULT_PARALLEL_ROW_THRESHOLD = 256;
+  static const std::size_t MESSAGE_ARENA_BYTES_PER_RECORD = 64;
+  static const std::size_t SHARD_COUNT = 16;
+  static const std::size_t GROUP_STACK_DEPTH = 16;
+  static const std::size_t BLOCK_TILE_ROWS = 8;
+  static const std::size_t BLOCK_TILE_COLUMNS = 128;
+  static const std::size_t BLOCKED_SWEEP_MIN_ELEMENTS = 65536;
+  static const std::size_t COMPARISON_CACHE_SIZE = 512;
+  static const std::size_t COMPARISON_CACHE_PROBE_LIMIT = 8;
+  static const std::size_t GROUP_RECORD_RESERVE = 64;
+
+  Shard shards[SHARD_COUNT];
+  bool deferred_reporting_enabled = false;
+  std::shared_ptr<Parallel::ThreadPool> parallel_pool;
+  std::shared_ptr<Parallel::ThreadPool> async_pool;
+  std::size_t parallel_row_threshold = DEFAULT_PARALLEL_ROW_THRESHOLD;
+  ScanPolicy scan_policy = ScanPolicy::FirstFailure;
+  ComparisonMode comparison_mode = ComparisonMode::Absolute;
+  struct CacheSlot {
+    bool used;
+    int message_id;
+    std::uint64_t digest;
+  };
+
+  GroupFrame group_stack[GROUP_STACK_DEPTH];
+  std::size_t group_depth = 0;
+  std::size_t group_overflow_depth = 0;
+  std::vector<GroupRecord> group_records;
+  bool comparison_cache_enabled = false;
+  std::size_t comparison_cache_hit_count = 0;
+  bool comparison_statistics_enabled = false;
+  ComparisonStats last_stats = {};
+  CacheSlot comparison_cache[COMPARISON_CACHE_SIZE] = {};
+#if defined(MCAP_TESTER_ENABLE_PROFILING)
+  ProfileSlot profile_table[PROFILE_TABLE_SIZE] = {};
+  std::size_t profile_overflow_count = 0;
+#endif
+};
+
+/* Separable build mode: with MCAP_TESTER_SEPARABLE defined the common
+ * instantiations are referenced from the precompiled static library
+ * (src/MCAP_tester.cpp) instead of being re-instantiated and re-optimized
+ * in every test translation unit. Include MCAP_tester_separable.hpp and
+ * link the MCAP_tester_compiled target to opt in. */
+#if defined(MCAP_TESTER_SEPARABLE)
+extern template class MCAPTester<float>;
+extern template class MCAPTester<double>;
+#endif
+
+} // namespace Tester
+
+#endif // MCAP_TESTER_HPP
@@ -0,0 +1,39 @@
+#ifndef MCAP_TESTER_DISPATCH_HPP
+#define MCAP_TESTER_DISPATCH_HPP
+
+#include <cstddef>
+
+namespace Tester {
+namespace Dispatch {
+
+/* Runtime CPU-dispatched comparison kernels, provided by the optional
+ * MCAP_tester_dispatch static library. The library compiles the hot
+ * float/double kernels once per instruction set (SSE2/AVX2/AVX-512 on
+ * x86-64) and probes the CPU once on first use, so one shipped binary runs
+ * the widest kernel each test machine supports instead of the baseline the
+ * including project was compiled at. Linking the library defines
+ * MCAP_TESTER_USE_DISPATCH, which routes MCAPTester's absolute-tolerance
+ * sweeps through these entry points. */
+
+std::size_t first_mismatch(const float *actual, const float *expected,
+                           std::size_t size, float tolerance);
+
+std::size_t first_mismatch(const double *actual, const double *expected,
+                           std::size_t size, double tolerance);
+
+std::size_t count_mismatch(const float *actual, const float *expected,
+                           std::size_t size, float tolerance,
+                           float *max_error);
+
+std::size_t count_mismatch(const double *actual, const double *expected,
+                           std::size_t size, double tolerance,
+                           double *max_error);
+
+/* Name of the selected kernel variant ("sse2", "avx2", "avx512" or
+ * "baseline"), for build diagnostics and benchmark labels. */
+const char *active_variant();
+
+} // namespace Dispatch
+} // namespace Tester
+
+#endif // MCAP_TESTER_DISPATCH_HPP
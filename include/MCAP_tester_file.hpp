@@ -0,0 +1,488 @@
+#ifndef MCAP_TESTER_FILE_HPP
+#define MCAP_TESTER_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Tester {
+namespace Golden {
+
+/* Binary golden-file layout: a 24-byte header followed by the raw element
+ * data, so the payload starts 8-byte aligned and can be compared directly
+ * from mapped pages without any parsing. */
+struct FileHeader {
+  char magic[8];
+  std::uint32_t element_size;
+  std::uint32_t reserved;
+  std::uint64_t element_count;
+};
+
+static const char FILE_MAGIC[8] = {'M', 'C', 'A', 'P', 'G', 'L', 'D', '1'};
+
+template <typename T>
+inline bool write_file(const std::string &path, const T *data,
+                       std::size_t size) {
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.element_size = static_cast<std::uint32_t>(sizeof(T));
+  header.reserved = 0;
+  header.element_count = static_cast<std::uint64_t>(size);
+
+  bool success = (std::fwrite(&header, sizeof(header), 1, file) == 1);
+  if (success && (size > 0)) {
+    success = (std::fwrite(data, sizeof(T), size, file) == size);
+  }
+
+  std::fclose(file);
+  return success;
+}
+
+template <typename T>
+inline bool write_file(const std::string &path, const std::vector<T> &data) {
+  return write_file(path, data.data(), data.size());
+}
+
+/* Maps a golden file and exposes its payload as a read-only range. On POSIX
+ * systems the expected data is memory mapped, so repeated runs against the
+ * same baselines are served from the page cache; elsewhere the file is read
+ * into an owned buffer instead. */
+template <typename T> class MappedFile {
+public:
+  explicit MappedFile(const std::string &path)
+      : data_ptr(nullptr), element_count(0), map_base(nullptr), map_size(0) {
+#if !defined(_WIN32)
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+      return;
+    }
+
+    struct stat file_info;
+    if ((::fstat(descriptor, &file_info) != 0) ||
+        (static_cast<std::size_t>(file_info.st_size) < sizeof(FileHeader))) {
+      ::close(descriptor);
+      return;
+    }
+
+    void *base = ::mmap(nullptr, static_cast<std::size_t>(file_info.st_size),
+                        PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (base == MAP_FAILED) {
+      return;
+    }
+
+    if (!validate_header(base, static_cast<std::size_t>(file_info.st_size))) {
+      ::munmap(base, static_cast<std::size_t>(file_info.st_size));
+      return;
+    }
+
+    map_base = base;
+    map_size = static_cast<std::size_t>(file_info.st_size);
+    data_ptr = reinterpret_cast<const T *>(static_cast<const char *>(base) +
+                                           sizeof(FileHeader));
+#else
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      return;
+    }
+
+    FileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1) {
+      std::fclose(file);
+      return;
+    }
+    if ((std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) ||
+        (header.element_size != sizeof(T))) {
+      std::fclose(file);
+      return;
+    }
+
+    owned_buffer.resize(static_cast<std::size_t>(header.element_count));
+    if (std::fread(owned_buffer.data(), sizeof(T), owned_buffer.size(),
+                   file) != owned_buffer.size()) {
+      std::fclose(file);
+      owned_buffer.clear();
+      return;
+    }
+    std::fclose(file);
+
+    data_ptr = owned_buffer.data();
+    element_count = owned_buffer.size();
+#endif
+  }
+
+  ~MappedFile() {
+#if !defined(_WIN32)
+    if (map_base != nullptr) {
+      ::munmap(map_base, map_size);
+    }
+#endif
+  }
+
+  bool valid() const { return data_ptr != nullptr; }
+
+  const T *data() const { return data_ptr; }
+
+  std::size_t size() const { return element_count; }
+
+private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  bool validate_header(const void *base, std::size_t file_size) {
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+      return false;
+    }
+    if (header.element_size != sizeof(T)) {
+      return false;
+    }
+    if ((sizeof(FileHeader) + (header.element_count * sizeof(T))) >
+        file_size) {
+      return false;
+    }
+
+    element_count = static_cast<std::size_t>(header.element_count);
+    return true;
+  }
+
+  const T *data_ptr;
+  std::size_t element_count;
+  void *map_base;
+  std::size_t map_size;
+#if defined(_WIN32)
+  std::vector<T> owned_buffer;
+#endif
+};
+
+/* Delta-compressed golden layout: a 24-byte header followed by XOR-encoded
+ * blocks of COMPRESSED_BLOCK_ELEMENTS elements. Within a block each element
+ * is XORed with its predecessor and stored as a control byte (offset nibble
+ * and length nibble of the significant byte run after trimming zeros from
+ * both ends) plus those bytes, so the near-identical high bits of smooth
+ * trajectories — and the all-zero low bytes of quantized ones — collapse to
+ * nothing; an unchanged element costs one byte.
+ * Blocks restart the predecessor at zero, so a decoder needs only one
+ * block-sized scratch buffer. */
+struct CompressedHeader {
+  char magic[8];
+  std::uint32_t element_size;
+  std::uint32_t block_elements;
+  std::uint64_t element_count;
+};
+
+static const char COMPRESSED_MAGIC[8] = {'M', 'C', 'A', 'P',
+                                         'G', 'D', 'X', '1'};
+
+static const std::size_t COMPRESSED_BLOCK_ELEMENTS = 4096;
+
+template <typename T>
+inline bool write_compressed_file(const std::string &path, const T *data,
+                                  std::size_t size) {
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  CompressedHeader header;
+  std::memcpy(header.magic, COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC));
+  header.element_size = static_cast<std::uint32_t>(sizeof(T));
+  header.block_elements =
+      static_cast<std::uint32_t>(COMPRESSED_BLOCK_ELEMENTS);
+  header.element_count = static_cast<std::uint64_t>(size);
+
+  std::vector<unsigned char> encoded;
+  encoded.reserve(size * (sizeof(T) + 1) / 4);
+
+  unsigned char previous[sizeof(T)];
+  for (std::size_t i = 0; i < size; i++) {
+    if ((i % COMPRESSED_BLOCK_ELEMENTS) == 0) {
+      std::memset(previous, 0, sizeof(previous));
+    }
+
+    unsigned char word[sizeof(T)];
+    std::memcpy(word, data + i, sizeof(T));
+
+    unsigned char delta[sizeof(T)];
+    for (std::size_t b = 0; b < sizeof(T); b++) {
+      delta[b] = static_cast<unsigned char>(word[b] ^ previous[b]);
+    }
+    std::memcpy(previous, word, sizeof(T));
+
+    std::size_t run_end = sizeof(T);
+    while ((run_end > 0) && (delta[run_end - 1] == 0)) {
+      run_end--;
+    }
+    std::size_t run_start = 0;
+    while ((run_start < run_end) && (delta[run_start] == 0)) {
+      run_start++;
+    }
+
+    encoded.push_back(static_cast<unsigned char>(
+        (run_start << 4) | (run_end - run_start)));
+    encoded.insert(encoded.end(), delta + run_start, delta + run_end);
+  }
+
+  bool success = (std::fwrite(&header, sizeof(header), 1, file) == 1);
+  if (success && !encoded.empty()) {
+    success = (std::fwrite(encoded.data(), 1, encoded.size(), file) ==
+               encoded.size());
+  }
+
+  std::fclose(file);
+  return success;
+}
+
+template <typename T>
+inline bool write_compressed_file(const std::string &path,
+                                  const std::vector<T> &data) {
+  return write_compressed_file(path, data.data(), data.size());
+}
+
+/* Streaming decoder for compressed golden files. The (already small)
+ * encoded stream is read into memory once; decode_block() then expands one
+ * block at a time into a caller-provided scratch buffer, so the decoded
+ * baseline never exists in full and decode overlaps with the comparison of
+ * the previous block's output. A malformed stream flips valid() to false
+ * mid-decode instead of reading out of bounds. */
+template <typename T> class CompressedFile {
+public:
+  explicit CompressedFile(const std::string &path)
+      : element_count(0), cursor(0), decoded_elements(0),
+        stream_valid(false) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      return;
+    }
+
+    CompressedHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1) {
+      std::fclose(file);
+      return;
+    }
+    if ((std::memcmp(header.magic, COMPRESSED_MAGIC,
+                     sizeof(COMPRESSED_MAGIC)) != 0) ||
+        (header.element_size != sizeof(T)) ||
+        (header.block_elements != COMPRESSED_BLOCK_ELEMENTS)) {
+      std::fclose(file);
+      return;
+    }
+
+    if (std::fseek(file, 0, SEEK_END) != 0) {
+      std::fclose(file);
+      return;
+    }
+    long end_position = std::ftell(file);
+    if (end_position < static_cast<long>(sizeof(header))) {
+      std::fclose(file);
+      return;
+    }
+    std::fseek(file, static_cast<long>(sizeof(header)), SEEK_SET);
+
+    encoded.resize(static_cast<std::size_t>(end_position) - sizeof(header));
+    if (!encoded.empty() &&
+        (std::fread(encoded.data(), 1, encoded.size(), file) !=
+         encoded.size())) {
+      std::fclose(file);
+      encoded.clear();
+      return;
+    }
+    std::fclose(file);
+
+    element_count = static_cast<std::size_t>(header.element_count);
+    stream_valid = true;
+  }
+
+  bool valid() const { return stream_valid; }
+
+  std::size_t size() const { return element_count; }
+
+  /* Decodes the next block into "scratch" (which must hold at least
+   * COMPRESSED_BLOCK_ELEMENTS elements). Returns the number of elements
+   * decoded; zero at end of stream or on a malformed stream. */
+  std::size_t decode_block(T *scratch) {
+    if (!stream_valid || (decoded_elements >= element_count)) {
+      return 0;
+    }
+
+    std::size_t remaining = element_count - decoded_elements;
+    std::size_t block = (remaining > COMPRESSED_BLOCK_ELEMENTS)
+                            ? COMPRESSED_BLOCK_ELEMENTS
+                            : remaining;
+
+    unsigned char previous[sizeof(T)];
+    std::memset(previous, 0, sizeof(previous));
+    for (std::size_t i = 0; i < block; i++) {
+      if (cursor >= encoded.size()) {
+        stream_valid = false;
+        return 0;
+      }
+      unsigned char control = encoded[cursor++];
+      std::size_t run_start = static_cast<std::size_t>(control >> 4);
+      std::size_t run_length = static_cast<std::size_t>(control & 0x0F);
+      if (((run_start + run_length) > sizeof(T)) ||
+          ((cursor + run_length) > encoded.size())) {
+        stream_valid = false;
+        return 0;
+      }
+
+      unsigned char word[sizeof(T)];
+      std::memcpy(word, previous, sizeof(T));
+      for (std::size_t b = 0; b < run_length; b++) {
+        word[run_start + b] =
+            static_cast<unsigned char>(word[run_start + b] ^
+                                       encoded[cursor + b]);
+      }
+      cursor += run_length;
+
+      std::memcpy(previous, word, sizeof(T));
+      std::memcpy(scratch + i, word, sizeof(T));
+    }
+
+    decoded_elements += block;
+    return block;
+  }
+
+private:
+  CompressedFile(const CompressedFile &);
+  CompressedFile &operator=(const CompressedFile &);
+
+  std::vector<unsigned char> encoded;
+  std::size_t element_count;
+  std::size_t cursor;
+  std::size_t decoded_elements;
+  bool stream_valid;
+};
+
+} // namespace Golden
+
+namespace Report {
+
+/* Binary failure-report layout: a 24-byte header followed by fixed-width
+ * 48-byte records, so CI tooling ingests results with a single read and a
+ * cast instead of scraping the text output with regexes. Values are widened
+ * to double in the records, so one reader handles every element type. */
+struct ReportHeader {
+  char magic[8];
+  std::uint32_t record_size;
+  std::uint32_t reserved;
+  std::uint64_t record_count;
+};
+
+static const char REPORT_MAGIC[8] = {'M', 'C', 'A', 'P', 'R', 'P', 'T', '1'};
+
+/* Numeric stand-in for the failure detail strings, so records stay
+ * fixed width and readers never parse text. */
+enum DetailCode {
+  DetailNone = 0,
+  DetailElementMismatch = 1,
+  DetailSizeMismatch = 2,
+  DetailNaN = 3,
+  DetailInfinite = 4,
+  DetailGoldenFileError = 5
+};
+
+struct ReportRecord {
+  std::int32_t message_id;
+  std::uint32_t detail_code;
+  std::uint64_t row;
+  std::uint64_t column;
+  double actual_value;
+  double expected_value;
+  double error;
+};
+
+inline bool write_report(const std::string &path, const ReportRecord *records,
+                         std::size_t count) {
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  ReportHeader header;
+  std::memcpy(header.magic, REPORT_MAGIC, sizeof(REPORT_MAGIC));
+  header.record_size = static_cast<std::uint32_t>(sizeof(ReportRecord));
+  header.reserved = 0;
+  header.record_count = static_cast<std::uint64_t>(count);
+
+  bool success = (std::fwrite(&header, sizeof(header), 1, file) == 1);
+  if (success && (count > 0)) {
+    success =
+        (std::fwrite(records, sizeof(ReportRecord), count, file) == count);
+  }
+
+  std::fclose(file);
+  return success;
+}
+
+inline bool write_report(const std::string &path,
+                         const std::vector<ReportRecord> &records) {
+  return write_report(path, records.data(), records.size());
+}
+
+/* Reads a failure report back into memory for dashboards and triage tools.
+ * The header is validated against the magic and the record size, so a
+ * report written by a different layout revision is rejected instead of
+ * being misinterpreted. */
+class ReportReader {
+public:
+  explicit ReportReader(const std::string &path) : header_valid(false) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      return;
+    }
+
+    ReportHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1) {
+      std::fclose(file);
+      return;
+    }
+    if ((std::memcmp(header.magic, REPORT_MAGIC, sizeof(REPORT_MAGIC)) != 0) ||
+        (header.record_size != sizeof(ReportRecord))) {
+      std::fclose(file);
+      return;
+    }
+
+    record_storage.resize(static_cast<std::size_t>(header.record_count));
+    if (std::fread(record_storage.data(), sizeof(ReportRecord),
+                   record_storage.size(), file) != record_storage.size()) {
+      std::fclose(file);
+      record_storage.clear();
+      return;
+    }
+    std::fclose(file);
+
+    header_valid = true;
+  }
+
+  bool valid() const { return header_valid; }
+
+  const std::vector<ReportRecord> &records() const { return record_storage; }
+
+  std::size_t size() const { return record_storage.size(); }
+
+private:
+  bool header_valid;
+  std::vector<ReportRecord> record_storage;
+};
+
+} // namespace Report
+} // namespace Tester
+
+#endif // MCAP_TESTER_FILE_HPP
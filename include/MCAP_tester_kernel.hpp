@@ -0,0 +1,864 @@
+#ifndef MCAP_TESTER_KERNEL_HPP
+#define MCAP_TESTER_KERNEL_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace Tester {
+namespace Kernel {
+
+/* Returns the index of the first element pair whose absolute difference
+ * exceeds the tolerance, or "size" when every pair is within tolerance.
+ * NaN in either operand makes the pair fail, matching the scalar check. */
+template <typename T>
+inline std::size_t first_mismatch_scalar(const T *actual, const T *expected,
+                                         std::size_t size, T tolerance) {
+  for (std::size_t i = 0; i < size; i++) {
+    if (std::abs(actual[i] - expected[i]) <= tolerance) {
+      /* Do Nothing. */
+    } else {
+      return i;
+    }
+  }
+  return size;
+}
+
+/* Absolute difference of two signed integers, formed in the unsigned domain
+ * so an INT_MIN-magnitude delta neither overflows nor detours through
+ * floating point. The branchless form vectorizes to PABS/VABD-class
+ * instructions. */
+template <typename T>
+inline typename std::make_unsigned<T>::type integer_abs_diff(T a, T b) {
+  typedef typename std::make_unsigned<T>::type Unsigned;
+  Unsigned ua = static_cast<Unsigned>(a);
+  Unsigned ub = static_cast<Unsigned>(b);
+  return (a > b) ? static_cast<Unsigned>(ua - ub)
+                 : static_cast<Unsigned>(ub - ua);
+}
+
+template <typename T>
+inline typename std::enable_if<!std::is_integral<T>::value, std::size_t>::type
+first_mismatch(const T *actual, const T *expected, std::size_t size,
+               T tolerance) {
+  return first_mismatch_scalar(actual, expected, size, tolerance);
+}
+
+/* Integer ranges (fixed-point Q15/Q31 data) compare natively in the
+ * unsigned domain. Negative tolerances are treated as zero. */
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value, std::size_t>::type
+first_mismatch(const T *actual, const T *expected, std::size_t size,
+               T tolerance) {
+  typedef typename std::make_unsigned<T>::type Unsigned;
+  Unsigned limit = (tolerance > static_cast<T>(0))
+                       ? static_cast<Unsigned>(tolerance)
+                       : static_cast<Unsigned>(0);
+  for (std::size_t i = 0; i < size; i++) {
+    if (integer_abs_diff(actual[i], expected[i]) <= limit) {
+      /* Do Nothing. */
+    } else {
+      return i;
+    }
+  }
+  return size;
+}
+
+/* Scans the whole range without branching on the comparison outcome and
+ * returns the number of out-of-tolerance pairs. The largest absolute
+ * difference seen over the range is written to "max_error" (NaN differences
+ * leave the maximum untouched, but still count as failures). */
+template <typename T>
+inline std::size_t count_mismatch_scalar(const T *actual, const T *expected,
+                                         std::size_t size, T tolerance,
+                                         T *max_error) {
+  std::size_t count = 0;
+  T max_difference = static_cast<T>(0);
+  for (std::size_t i = 0; i < size; i++) {
+    T difference = std::abs(actual[i] - expected[i]);
+    count += static_cast<std::size_t>(!(difference <= tolerance));
+    max_difference =
+        (difference > max_difference) ? difference : max_difference;
+  }
+
+  *max_error = max_difference;
+  return count;
+}
+
+template <typename T>
+inline typename std::enable_if<!std::is_integral<T>::value, std::size_t>::type
+count_mismatch(const T *actual, const T *expected, std::size_t size,
+               T tolerance, T *max_error) {
+  return count_mismatch_scalar(actual, expected, size, tolerance, max_error);
+}
+
+/* Integer counting sweep. The reported maximum difference saturates to the
+ * element type's maximum, since the true unsigned difference can exceed it
+ * by one bit. */
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value, std::size_t>::type
+count_mismatch(const T *actual, const T *expected, std::size_t size,
+               T tolerance, T *max_error) {
+  typedef typename std::make_unsigned<T>::type Unsigned;
+  Unsigned limit = (tolerance > static_cast<T>(0))
+                       ? static_cast<Unsigned>(tolerance)
+                       : static_cast<Unsigned>(0);
+  std::size_t count = 0;
+  Unsigned max_difference = static_cast<Unsigned>(0);
+  for (std::size_t i = 0; i < size; i++) {
+    Unsigned difference = integer_abs_diff(actual[i], expected[i]);
+    count += static_cast<std::size_t>(!(difference <= limit));
+    max_difference =
+        (difference > max_difference) ? difference : max_difference;
+  }
+
+  Unsigned type_max = static_cast<Unsigned>(
+      (std::numeric_limits<T>::max)());
+  *max_error = static_cast<T>(
+      (max_difference > type_max) ? type_max : max_difference);
+  return count;
+}
+
+/* Distance between two floats counted in representable steps, computed in
+ * the integer domain: the bit patterns are remapped so that the total order
+ * of the remapped integers matches the order of the float values, after
+ * which the ULP distance is a plain subtraction. NaN compares as infinitely
+ * far from everything. */
+inline std::uint32_t ulp_distance(float a, float b) {
+  if ((a != a) || (b != b)) {
+    return UINT32_MAX;
+  }
+
+  std::int32_t ia;
+  std::int32_t ib;
+  std::memcpy(&ia, &a, sizeof(ia));
+  std::memcpy(&ib, &b, sizeof(ib));
+  if (ia < 0) {
+    ia = static_cast<std::int32_t>(INT32_MIN) - ia;
+  }
+  if (ib < 0) {
+    ib = static_cast<std::int32_t>(INT32_MIN) - ib;
+  }
+
+  std::int64_t distance = static_cast<std::int64_t>(ia) -
+                          static_cast<std::int64_t>(ib);
+  return static_cast<std::uint32_t>((distance < 0) ? (-distance) : distance);
+}
+
+inline std::uint64_t ulp_distance(double a, double b) {
+  if ((a != a) || (b != b)) {
+    return UINT64_MAX;
+  }
+
+  std::int64_t ia;
+  std::int64_t ib;
+  std::memcpy(&ia, &a, sizeof(ia));
+  std::memcpy(&ib, &b, sizeof(ib));
+  if (ia < 0) {
+    ia = INT64_MIN - ia;
+  }
+  if (ib < 0) {
+    ib = INT64_MIN - ib;
+  }
+
+  std::uint64_t distance = (ia > ib)
+                               ? (static_cast<std::uint64_t>(ia) -
+                                  static_cast<std::uint64_t>(ib))
+                               : (static_cast<std::uint64_t>(ib) -
+                                  static_cast<std::uint64_t>(ia));
+  return distance;
+}
+
+/* Magnitude and difference helpers shared by the relative kernels, defined
+ * for every element type: unsigned values are their own magnitude, and
+ * integral differences are formed in the unsigned domain (saturated back to
+ * T) instead of through std::abs. */
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, T>::type
+pair_abs_diff(T a, T b) {
+  return std::abs(a - b);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value, T>::type
+pair_abs_diff(T a, T b) {
+  typedef typename std::make_unsigned<T>::type Unsigned;
+  Unsigned difference = integer_abs_diff(a, b);
+  Unsigned type_max = static_cast<Unsigned>((std::numeric_limits<T>::max)());
+  return static_cast<T>((difference > type_max) ? type_max : difference);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_unsigned<T>::value, T>::type
+magnitude(T value) {
+  return value;
+}
+
+template <typename T>
+inline typename std::enable_if<!std::is_unsigned<T>::value, T>::type
+magnitude(T value) {
+  return std::abs(value);
+}
+
+/* Relative-tolerance variants: a pair passes when the absolute difference is
+ * within tolerance * max(|actual|, |expected|). */
+template <typename T>
+inline std::size_t first_mismatch_relative(const T *actual, const T *expected,
+                                           std::size_t size, T tolerance) {
+  for (std::size_t i = 0; i < size; i++) {
+    T difference = pair_abs_diff(actual[i], expected[i]);
+    T magnitude_a = magnitude(actual[i]);
+    T magnitude_e = magnitude(expected[i]);
+    T scale = (magnitude_a > magnitude_e) ? magnitude_a : magnitude_e;
+    if (difference <= (tolerance * scale)) {
+      /* Do Nothing. */
+    } else {
+      return i;
+    }
+  }
+  return size;
+}
+
+template <typename T>
+inline std::size_t count_mismatch_relative(const T *actual, const T *expected,
+                                           std::size_t size, T tolerance,
+                                           T *max_error) {
+  std::size_t count = 0;
+  T max_difference = static_cast<T>(0);
+  for (std::size_t i = 0; i < size; i++) {
+    T difference = pair_abs_diff(actual[i], expected[i]);
+    T magnitude_a = magnitude(actual[i]);
+    T magnitude_e = magnitude(expected[i]);
+    T scale = (magnitude_a > magnitude_e) ? magnitude_a : magnitude_e;
+    count += static_cast<std::size_t>(!(difference <= (tolerance * scale)));
+    max_difference =
+        (difference > max_difference) ? difference : max_difference;
+  }
+
+  *max_error = max_difference;
+  return count;
+}
+
+/* Statistics sweep: accumulates the mismatch count, the maximum absolute
+ * error and the sums feeding mean and RMS in the same pass as the tolerance
+ * check, so an instrumented assertion touches each buffer once instead of
+ * re-reading it for a separate statistics pass. The body is branchless, so
+ * the compiler keeps the accumulators in vector registers. */
+template <typename T>
+inline std::size_t count_mismatch_stats(const T *actual, const T *expected,
+                                        std::size_t size, T tolerance,
+                                        double *max_error, double *sum_error,
+                                        double *sum_squared_error) {
+  std::size_t count = 0;
+  double max_difference = 0.0;
+  double sum = 0.0;
+  double sum_squared = 0.0;
+  for (std::size_t i = 0; i < size; i++) {
+    T difference = pair_abs_diff(actual[i], expected[i]);
+    double wide_difference = static_cast<double>(difference);
+    count += static_cast<std::size_t>(!(difference <= tolerance));
+    max_difference =
+        (wide_difference > max_difference) ? wide_difference : max_difference;
+    sum += wide_difference;
+    sum_squared += wide_difference * wide_difference;
+  }
+
+  *max_error = max_difference;
+  *sum_error = sum;
+  *sum_squared_error = sum_squared;
+  return count;
+}
+
+/* Bitwise exact-match sweeps for the ExactMatch tolerance profile. The bulk
+ * pass is a single memcmp over the raw bytes, so the libc wide compare runs
+ * instead of a per-element abs-subtract-compare sequence; only when the bulk
+ * pass reports a difference does a block-wise rescan locate the first
+ * differing element. */
+static const std::size_t EXACT_LOCATE_BLOCK_BYTES = 4096;
+
+template <typename T>
+inline std::size_t first_mismatch_exact(const T *actual, const T *expected,
+                                        std::size_t size) {
+  const std::size_t total_bytes = size * sizeof(T);
+  if (std::memcmp(actual, expected, total_bytes) == 0) {
+    return size;
+  }
+
+  const unsigned char *actual_bytes =
+      reinterpret_cast<const unsigned char *>(actual);
+  const unsigned char *expected_bytes =
+      reinterpret_cast<const unsigned char *>(expected);
+  std::size_t offset = 0;
+  while (offset < total_bytes) {
+    std::size_t block = total_bytes - offset;
+    block = (block > EXACT_LOCATE_BLOCK_BYTES) ? EXACT_LOCATE_BLOCK_BYTES
+                                               : block;
+    if (std::memcmp(actual_bytes + offset, expected_bytes + offset, block) !=
+        0) {
+      for (std::size_t i = 0; i < block; i++) {
+        if (actual_bytes[offset + i] != expected_bytes[offset + i]) {
+          return (offset + i) / sizeof(T);
+        }
+      }
+    }
+    offset += block;
+  }
+
+  return size;
+}
+
+template <typename T>
+inline std::size_t count_mismatch_exact(const T *actual, const T *expected,
+                                        std::size_t size) {
+  if (std::memcmp(actual, expected, size * sizeof(T)) == 0) {
+    return 0;
+  }
+
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < size; i++) {
+    count += static_cast<std::size_t>(
+        std::memcmp(actual + i, expected + i, sizeof(T)) != 0);
+  }
+  return count;
+}
+
+/* FNV-1a digest over raw bytes, folded eight bytes at a time. Used by the
+ * comparison cache to fingerprint buffers; collisions are possible in
+ * principle, which is why the cache digests both operands and the tolerance
+ * before trusting a previous pass. */
+inline std::uint64_t digest_bytes(const void *data, std::size_t size_bytes,
+                                  std::uint64_t seed) {
+  static const std::uint64_t FNV_PRIME = 0x100000001B3ULL;
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  std::uint64_t hash = seed;
+
+  std::size_t word_count = size_bytes / sizeof(std::uint64_t);
+  for (std::size_t i = 0; i < word_count; i++) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+    hash = (hash ^ word) * FNV_PRIME;
+  }
+
+  for (std::size_t i = word_count * sizeof(std::uint64_t); i < size_bytes;
+       i++) {
+    hash = (hash ^ static_cast<std::uint64_t>(bytes[i])) * FNV_PRIME;
+  }
+
+  return hash;
+}
+
+/* Heterogeneous variants: actual and expected may differ in element type
+ * (float model output against double golden data). Each lane is widened to
+ * the common type in registers during the sweep, so mixed-precision
+ * comparisons take one pass and no conversion buffer. */
+template <typename ActualT, typename ExpectedT>
+inline std::size_t
+first_mismatch_mixed(const ActualT *actual, const ExpectedT *expected,
+                     std::size_t size,
+                     typename std::common_type<ActualT, ExpectedT>::type
+                         tolerance) {
+  typedef typename std::common_type<ActualT, ExpectedT>::type Common;
+  for (std::size_t i = 0; i < size; i++) {
+    Common difference = std::abs(static_cast<Common>(actual[i]) -
+                                 static_cast<Common>(expected[i]));
+    if (difference <= tolerance) {
+      /* Do Nothing. */
+    } else {
+      return i;
+    }
+  }
+  return size;
+}
+
+template <typename ActualT, typename ExpectedT>
+inline std::size_t
+count_mismatch_mixed(const ActualT *actual, const ExpectedT *expected,
+                     std::size_t size,
+                     typename std::common_type<ActualT, ExpectedT>::type
+                         tolerance,
+                     typename std::common_type<ActualT, ExpectedT>::type
+                         *max_error) {
+  typedef typename std::common_type<ActualT, ExpectedT>::type Common;
+  std::size_t count = 0;
+  Common max_difference = static_cast<Common>(0);
+  for (std::size_t i = 0; i < size; i++) {
+    Common difference = std::abs(static_cast<Common>(actual[i]) -
+                                 static_cast<Common>(expected[i]));
+    count += static_cast<std::size_t>(!(difference <= tolerance));
+    max_difference =
+        (difference > max_difference) ? difference : max_difference;
+  }
+
+  *max_error = max_difference;
+  return count;
+}
+
+/* Non-finite classification through the exponent bits. The sweep kernels
+ * already fail NaN/Inf pairs via their unordered compares, so these run only
+ * on the failure path to label the diagnostic; no separate isnan/isinf
+ * pre-scan of the data is needed. Non-floating-point element types are
+ * always finite. */
+inline bool is_nan_value(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x7FFFFFFFU) > 0x7F800000U;
+}
+
+inline bool is_nan_value(double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x7FFFFFFFFFFFFFFFULL) > 0x7FF0000000000000ULL;
+}
+
+template <typename T> inline bool is_nan_value(T) { return false; }
+
+inline bool is_inf_value(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x7FFFFFFFU) == 0x7F800000U;
+}
+
+inline bool is_inf_value(double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x7FFFFFFFFFFFFFFFULL) == 0x7FF0000000000000ULL;
+}
+
+template <typename T> inline bool is_inf_value(T) { return false; }
+
+/* Per-element tolerance variants for the batch assertion API. The tolerance
+ * stream is loaded alongside the data, so the loops stay branchless and
+ * vectorizable; NaN differences fail through the negated compare. */
+template <typename T>
+inline std::size_t first_mismatch_batch(const T *actual, const T *expected,
+                                        const T *tolerances, std::size_t begin,
+                                        std::size_t size) {
+  for (std::size_t i = begin; i < size; i++) {
+    T difference = std::abs(actual[i] - expected[i]);
+    if (difference <= tolerances[i]) {
+      /* Do Nothing. */
+    } else {
+      return i;
+    }
+  }
+  return size;
+}
+
+template <typename T>
+inline std::size_t count_mismatch_batch(const T *actual, const T *expected,
+                                        const T *tolerances, std::size_t size,
+                                        T *max_error) {
+  std::size_t count = 0;
+  T max_difference = static_cast<T>(0);
+  for (std::size_t i = 0; i < size; i++) {
+    T difference = std::abs(actual[i] - expected[i]);
+    count += static_cast<std::size_t>(!(difference <= tolerances[i]));
+    max_difference =
+        (difference > max_difference) ? difference : max_difference;
+  }
+
+  *max_error = max_difference;
+  return count;
+}
+
+/* ULP-tolerance variants for floating-point data. The limit is the largest
+ * accepted step distance; the whole compare stays in the integer domain. */
+template <typename T>
+inline std::size_t first_mismatch_ulp(const T *actual, const T *expected,
+                                      std::size_t size,
+                                      std::uint64_t max_ulps) {
+  for (std::size_t i = 0; i < size; i++) {
+    if (static_cast<std::uint64_t>(ulp_distance(actual[i], expected[i])) <=
+        max_ulps) {
+      /* Do Nothing. */
+    } else {
+      return i;
+    }
+  }
+  return size;
+}
+
+template <typename T>
+inline std::size_t count_mismatch_ulp(const T *actual, const T *expected,
+                                      std::size_t size, std::uint64_t max_ulps,
+                                      T *max_error) {
+  std::size_t count = 0;
+  T max_difference = static_cast<T>(0);
+  for (std::size_t i = 0; i < size; i++) {
+    count += static_cast<std::size_t>(
+        static_cast<std::uint64_t>(ulp_distance(actual[i], expected[i])) >
+        max_ulps);
+    T difference = std::abs(actual[i] - expected[i]);
+    max_difference =
+        (difference > max_difference) ? difference : max_difference;
+  }
+
+  *max_error = max_difference;
+  return count;
+}
+
+/* Fully unrolled first_mismatch for sizes known at compile time. Each
+ * element becomes a straight-line compare with no loop counter. */
+template <typename T, std::size_t Index, std::size_t N>
+struct UnrolledMismatch {
+  static inline std::size_t find(const T *actual, const T *expected,
+                                 T tolerance) {
+    if (std::abs(actual[Index] - expected[Index]) <= tolerance) {
+      return UnrolledMismatch<T, (Index + 1), N>::find(actual, expected,
+                                                       tolerance);
+    }
+    return Index;
+  }
+};
+
+template <typename T, std::size_t N> struct UnrolledMismatch<T, N, N> {
+  static inline std::size_t find(const T *, const T *, T) { return N; }
+};
+
+/* Sizes up to this are fully unrolled; larger fixed sizes go through the
+ * runtime kernel, which already tiles the range in SIMD-width blocks. */
+static const std::size_t UNROLL_SIZE_LIMIT = 16;
+
+template <std::size_t N, typename T>
+inline typename std::enable_if<(N <= UNROLL_SIZE_LIMIT), std::size_t>::type
+first_mismatch_fixed(const T *actual, const T *expected, T tolerance) {
+  return UnrolledMismatch<T, 0, N>::find(actual, expected, tolerance);
+}
+
+template <std::size_t N, typename T>
+inline typename std::enable_if<(N > UNROLL_SIZE_LIMIT), std::size_t>::type
+first_mismatch_fixed(const T *actual, const T *expected, T tolerance) {
+  return first_mismatch(actual, expected, N, tolerance);
+}
+
+inline std::size_t popcount_mask(unsigned int mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::size_t>(__builtin_popcount(mask));
+#else
+  std::size_t count = 0;
+  while (mask != 0U) {
+    mask &= (mask - 1U);
+    count++;
+  }
+  return count;
+#endif
+}
+
+#if defined(__AVX__)
+
+template <>
+inline std::size_t first_mismatch<float>(const float *actual,
+                                         const float *expected,
+                                         std::size_t size, float tolerance) {
+  const __m256 abs_mask =
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+  const __m256 tol = _mm256_set1_ps(tolerance);
+
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256 difference = _mm256_and_ps(
+        _mm256_sub_ps(_mm256_loadu_ps(actual + i),
+                      _mm256_loadu_ps(expected + i)),
+        abs_mask);
+    /* NLE compares true for unordered lanes, so NaN trips the mask. */
+    __m256 failed = _mm256_cmp_ps(difference, tol, _CMP_NLE_UQ);
+    if (_mm256_movemask_ps(failed) != 0) {
+      return i + first_mismatch_scalar(actual + i, expected + i,
+                                       static_cast<std::size_t>(8), tolerance);
+    }
+  }
+
+  return i + first_mismatch_scalar(actual + i, expected + i, size - i,
+                                   tolerance);
+}
+
+template <>
+inline std::size_t first_mismatch<double>(const double *actual,
+                                          const double *expected,
+                                          std::size_t size, double tolerance) {
+  const __m256d abs_mask = _mm256_castsi256_pd(
+      _mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m256d tol = _mm256_set1_pd(tolerance);
+
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256d difference = _mm256_and_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(actual + i),
+                      _mm256_loadu_pd(expected + i)),
+        abs_mask);
+    __m256d failed = _mm256_cmp_pd(difference, tol, _CMP_NLE_UQ);
+    if (_mm256_movemask_pd(failed) != 0) {
+      return i + first_mismatch_scalar(actual + i, expected + i,
+                                       static_cast<std::size_t>(4), tolerance);
+    }
+  }
+
+  return i + first_mismatch_scalar(actual + i, expected + i, size - i,
+                                   tolerance);
+}
+
+template <>
+inline std::size_t count_mismatch<float>(const float *actual,
+                                         const float *expected,
+                                         std::size_t size, float tolerance,
+                                         float *max_error) {
+  const __m256 abs_mask =
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+  const __m256 tol = _mm256_set1_ps(tolerance);
+  __m256 max_difference = _mm256_setzero_ps();
+
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m256 difference = _mm256_and_ps(
+        _mm256_sub_ps(_mm256_loadu_ps(actual + i),
+                      _mm256_loadu_ps(expected + i)),
+        abs_mask);
+    __m256 failed = _mm256_cmp_ps(difference, tol, _CMP_NLE_UQ);
+    count += popcount_mask(
+        static_cast<unsigned int>(_mm256_movemask_ps(failed)));
+    /* Operand order makes maxps keep the accumulator on NaN lanes. */
+    max_difference = _mm256_max_ps(difference, max_difference);
+  }
+
+  __m128 folded = _mm_max_ps(_mm256_castps256_ps128(max_difference),
+                             _mm256_extractf128_ps(max_difference, 1));
+  folded = _mm_max_ps(folded, _mm_movehl_ps(folded, folded));
+  folded = _mm_max_ss(folded, _mm_shuffle_ps(folded, folded, 0x1));
+  float max_difference_scalar = _mm_cvtss_f32(folded);
+
+  float tail_max = 0.0F;
+  count += count_mismatch_scalar(actual + i, expected + i, size - i, tolerance,
+                                 &tail_max);
+  *max_error = (tail_max > max_difference_scalar) ? tail_max
+                                                  : max_difference_scalar;
+  return count;
+}
+
+template <>
+inline std::size_t count_mismatch<double>(const double *actual,
+                                          const double *expected,
+                                          std::size_t size, double tolerance,
+                                          double *max_error) {
+  const __m256d abs_mask = _mm256_castsi256_pd(
+      _mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m256d tol = _mm256_set1_pd(tolerance);
+  __m256d max_difference = _mm256_setzero_pd();
+
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256d difference = _mm256_and_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(actual + i),
+                      _mm256_loadu_pd(expected + i)),
+        abs_mask);
+    __m256d failed = _mm256_cmp_pd(difference, tol, _CMP_NLE_UQ);
+    count += popcount_mask(
+        static_cast<unsigned int>(_mm256_movemask_pd(failed)));
+    max_difference = _mm256_max_pd(difference, max_difference);
+  }
+
+  __m128d folded = _mm_max_pd(_mm256_castpd256_pd128(max_difference),
+                              _mm256_extractf128_pd(max_difference, 1));
+  folded = _mm_max_sd(folded, _mm_unpackhi_pd(folded, folded));
+  double max_difference_scalar = _mm_cvtsd_f64(folded);
+
+  double tail_max = 0.0;
+  count += count_mismatch_scalar(actual + i, expected + i, size - i, tolerance,
+                                 &tail_max);
+  *max_error = (tail_max > max_difference_scalar) ? tail_max
+                                                  : max_difference_scalar;
+  return count;
+}
+
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+
+template <>
+inline std::size_t first_mismatch<float>(const float *actual,
+                                         const float *expected,
+                                         std::size_t size, float tolerance) {
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  const __m128 tol = _mm_set1_ps(tolerance);
+
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m128 difference = _mm_and_ps(
+        _mm_sub_ps(_mm_loadu_ps(actual + i), _mm_loadu_ps(expected + i)),
+        abs_mask);
+    /* cmpnle compares true for unordered lanes, so NaN trips the mask. */
+    __m128 failed = _mm_cmpnle_ps(difference, tol);
+    if (_mm_movemask_ps(failed) != 0) {
+      return i + first_mismatch_scalar(actual + i, expected + i,
+                                       static_cast<std::size_t>(4), tolerance);
+    }
+  }
+
+  return i + first_mismatch_scalar(actual + i, expected + i, size - i,
+                                   tolerance);
+}
+
+template <>
+inline std::size_t first_mismatch<double>(const double *actual,
+                                          const double *expected,
+                                          std::size_t size, double tolerance) {
+  const __m128d abs_mask = _mm_castsi128_pd(
+      _mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m128d tol = _mm_set1_pd(tolerance);
+
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    __m128d difference = _mm_and_pd(
+        _mm_sub_pd(_mm_loadu_pd(actual + i), _mm_loadu_pd(expected + i)),
+        abs_mask);
+    __m128d failed = _mm_cmpnle_pd(difference, tol);
+    if (_mm_movemask_pd(failed) != 0) {
+      return i + first_mismatch_scalar(actual + i, expected + i,
+                                       static_cast<std::size_t>(2), tolerance);
+    }
+  }
+
+  return i + first_mismatch_scalar(actual + i, expected + i, size - i,
+                                   tolerance);
+}
+
+template <>
+inline std::size_t count_mismatch<float>(const float *actual,
+                                         const float *expected,
+                                         std::size_t size, float tolerance,
+                                         float *max_error) {
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  const __m128 tol = _mm_set1_ps(tolerance);
+  __m128 max_difference = _mm_setzero_ps();
+
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m128 difference = _mm_and_ps(
+        _mm_sub_ps(_mm_loadu_ps(actual + i), _mm_loadu_ps(expected + i)),
+        abs_mask);
+    __m128 failed = _mm_cmpnle_ps(difference, tol);
+    count += popcount_mask(
+        static_cast<unsigned int>(_mm_movemask_ps(failed)));
+    /* Operand order makes maxps keep the accumulator on NaN lanes. */
+    max_difference = _mm_max_ps(difference, max_difference);
+  }
+
+  __m128 folded =
+      _mm_max_ps(max_difference, _mm_movehl_ps(max_difference, max_difference));
+  folded = _mm_max_ss(folded, _mm_shuffle_ps(folded, folded, 0x1));
+  float max_difference_scalar = _mm_cvtss_f32(folded);
+
+  float tail_max = 0.0F;
+  count += count_mismatch_scalar(actual + i, expected + i, size - i, tolerance,
+                                 &tail_max);
+  *max_error = (tail_max > max_difference_scalar) ? tail_max
+                                                  : max_difference_scalar;
+  return count;
+}
+
+template <>
+inline std::size_t count_mismatch<double>(const double *actual,
+                                          const double *expected,
+                                          std::size_t size, double tolerance,
+                                          double *max_error) {
+  const __m128d abs_mask = _mm_castsi128_pd(
+      _mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+  const __m128d tol = _mm_set1_pd(tolerance);
+  __m128d max_difference = _mm_setzero_pd();
+
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    __m128d difference = _mm_and_pd(
+        _mm_sub_pd(_mm_loadu_pd(actual + i), _mm_loadu_pd(expected + i)),
+        abs_mask);
+    __m128d failed = _mm_cmpnle_pd(difference, tol);
+    count += popcount_mask(
+        static_cast<unsigned int>(_mm_movemask_pd(failed)));
+    max_difference = _mm_max_pd(difference, max_difference);
+  }
+
+  __m128d folded =
+      _mm_max_sd(max_difference, _mm_unpackhi_pd(max_difference, max_difference));
+  double max_difference_scalar = _mm_cvtsd_f64(folded);
+
+  double tail_max = 0.0;
+  count += count_mismatch_scalar(actual + i, expected + i, size - i, tolerance,
+                                 &tail_max);
+  *max_error = (tail_max > max_difference_scalar) ? tail_max
+                                                  : max_difference_scalar;
+  return count;
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+template <>
+inline std::size_t first_mismatch<float>(const float *actual,
+                                         const float *expected,
+                                         std::size_t size, float tolerance) {
+  const float32x4_t tol = vdupq_n_f32(tolerance);
+
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    float32x4_t difference =
+        vabdq_f32(vld1q_f32(actual + i), vld1q_f32(expected + i));
+    /* vcle is false for NaN lanes, so the inverted mask flags them. */
+    uint32x4_t failed = vmvnq_u32(vcleq_f32(difference, tol));
+
+    uint32x2_t folded =
+        vorr_u32(vget_low_u32(failed), vget_high_u32(failed));
+    if ((vget_lane_u32(folded, 0) | vget_lane_u32(folded, 1)) != 0U) {
+      return i + first_mismatch_scalar(actual + i, expected + i,
+                                       static_cast<std::size_t>(4), tolerance);
+    }
+  }
+
+  return i + first_mismatch_scalar(actual + i, expected + i, size - i,
+                                   tolerance);
+}
+
+#if defined(__aarch64__)
+
+template <>
+inline std::size_t first_mismatch<double>(const double *actual,
+                                          const double *expected,
+                                          std::size_t size, double tolerance) {
+  const float64x2_t tol = vdupq_n_f64(tolerance);
+
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    float64x2_t difference =
+        vabdq_f64(vld1q_f64(actual + i), vld1q_f64(expected + i));
+    uint64x2_t passed = vcleq_f64(difference, tol);
+
+    if ((vgetq_lane_u64(passed, 0) & vgetq_lane_u64(passed, 1)) == 0U) {
+      return i + first_mismatch_scalar(actual + i, expected + i,
+                                       static_cast<std::size_t>(2), tolerance);
+    }
+  }
+
+  return i + first_mismatch_scalar(actual + i, expected + i, size - i,
+                                   tolerance);
+}
+
+#endif // __aarch64__
+
+#endif // SIMD dispatch
+
+} // namespace Kernel
+} // namespace Tester
+
+#endif // MCAP_TESTER_KERNEL_HPP
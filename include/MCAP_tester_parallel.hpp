@@ -0,0 +1,179 @@
+#ifndef MCAP_TESTER_PARALLEL_HPP
+#define MCAP_TESTER_PARALLEL_HPP
+
+#include "MCAP_tester_kernel.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Tester {
+namespace Parallel {
+
+/* Minimal C++11 thread pool used by the parallel comparison path. Tasks are
+ * queued with run() and wait_idle() blocks until every queued task finished. */
+class ThreadPool {
+public:
+  explicit ThreadPool(std::size_t thread_count)
+      : pending_task_count(0), stopping(false) {
+    if (thread_count == 0) {
+      thread_count = 1;
+    }
+    for (std::size_t i = 0; i < thread_count; i++) {
+      workers.push_back(std::thread(&ThreadPool::worker_loop, this));
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      stopping = true;
+    }
+    task_available.notify_all();
+    for (std::size_t i = 0; i < workers.size(); i++) {
+      workers[i].join();
+    }
+  }
+
+  std::size_t thread_count() const { return workers.size(); }
+
+  void run(const std::function<void()> &task) {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      task_queue.push_back(task);
+      pending_task_count++;
+    }
+    task_available.notify_one();
+  }
+
+  void wait_idle() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    while (pending_task_count > 0) {
+      all_tasks_done.wait(lock);
+    }
+  }
+
+private:
+  void worker_loop() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        while (task_queue.empty() && (!stopping)) {
+          task_available.wait(lock);
+        }
+        if (task_queue.empty()) {
+          return;
+        }
+        task = task_queue.front();
+        task_queue.pop_front();
+      }
+
+      task();
+
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        pending_task_count--;
+        if (pending_task_count == 0) {
+          all_tasks_done.notify_all();
+        }
+      }
+    }
+  }
+
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> task_queue;
+  std::mutex queue_mutex;
+  std::condition_variable task_available;
+  std::condition_variable all_tasks_done;
+  std::size_t pending_task_count;
+  bool stopping;
+};
+
+struct RowMismatch {
+  bool found;
+  bool size_mismatch;
+  std::size_t row;
+  std::size_t column;
+};
+
+/* Partitions rows across the pool workers. Each worker records the first
+ * failing position in its own chunk and the chunks are merged afterwards, so
+ * the result matches what the serial row walk would have reported. */
+template <typename T>
+inline RowMismatch
+first_mismatch_rows(ThreadPool &pool, const std::vector<std::vector<T>> &actual,
+                    const std::vector<std::vector<T>> &expected, T tolerance) {
+  const std::size_t row_count = actual.size();
+  const std::size_t chunk_count = pool.thread_count();
+  const std::size_t rows_per_chunk = (row_count + chunk_count - 1) / chunk_count;
+
+  std::vector<RowMismatch> chunk_results(chunk_count);
+
+  for (std::size_t c = 0; c < chunk_count; c++) {
+    const std::size_t row_begin = c * rows_per_chunk;
+    const std::size_t row_end =
+        ((row_begin + rows_per_chunk) < row_count) ? (row_begin + rows_per_chunk)
+                                                   : row_count;
+    RowMismatch *result = &chunk_results[c];
+    result->found = false;
+    result->size_mismatch = false;
+    result->row = 0;
+    result->column = 0;
+    if (row_begin >= row_end) {
+      continue;
+    }
+
+    const std::vector<std::vector<T>> *actual_ptr = &actual;
+    const std::vector<std::vector<T>> *expected_ptr = &expected;
+    pool.run([actual_ptr, expected_ptr, tolerance, row_begin, row_end,
+              result]() {
+      for (std::size_t i = row_begin; i < row_end; i++) {
+        const std::vector<T> &actual_row = (*actual_ptr)[i];
+        const std::vector<T> &expected_row = (*expected_ptr)[i];
+        if (actual_row.size() != expected_row.size()) {
+          result->found = true;
+          result->size_mismatch = true;
+          result->row = i;
+          return;
+        }
+
+        std::size_t index =
+            Kernel::first_mismatch(actual_row.data(), expected_row.data(),
+                                   actual_row.size(), tolerance);
+        if (index < actual_row.size()) {
+          result->found = true;
+          result->size_mismatch = false;
+          result->row = i;
+          result->column = index;
+          return;
+        }
+      }
+    });
+  }
+
+  pool.wait_idle();
+
+  RowMismatch merged;
+  merged.found = false;
+  merged.size_mismatch = false;
+  merged.row = 0;
+  merged.column = 0;
+  for (std::size_t c = 0; c < chunk_count; c++) {
+    if (chunk_results[c].found) {
+      merged = chunk_results[c];
+      break;
+    }
+  }
+
+  return merged;
+}
+
+} // namespace Parallel
+} // namespace Tester
+
+#endif // MCAP_TESTER_PARALLEL_HPP
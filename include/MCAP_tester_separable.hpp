@@ -0,0 +1,16 @@
+#ifndef MCAP_TESTER_SEPARABLE_HPP
+#define MCAP_TESTER_SEPARABLE_HPP
+
+/* Forwarding header for the separable build. Defines MCAP_TESTER_SEPARABLE
+ * before pulling in the main header, so the float and double instantiations
+ * of MCAPTester come from the precompiled MCAP_tester_compiled static
+ * library instead of being instantiated again in the including translation
+ * unit. Generated test suites include this header and link that library. */
+
+#ifndef MCAP_TESTER_SEPARABLE
+#define MCAP_TESTER_SEPARABLE
+#endif
+
+#include "MCAP_tester.hpp"
+
+#endif // MCAP_TESTER_SEPARABLE_HPP
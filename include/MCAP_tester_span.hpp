@@ -0,0 +1,132 @@
+#ifndef MCAP_TESTER_SPAN_HPP
+#define MCAP_TESTER_SPAN_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Tester {
+
+/* Non-owning view over a contiguous buffer. The caller keeps ownership and
+ * must keep the buffer alive while the view is in use. */
+template <typename T> class Span {
+public:
+  Span() : data_ptr(nullptr), element_count(0) {}
+
+  Span(const T *data_in, std::size_t size_in)
+      : data_ptr(data_in), element_count(size_in) {}
+
+  Span(const std::vector<T> &source)
+      : data_ptr(source.data()), element_count(source.size()) {}
+
+  template <std::size_t N>
+  Span(const std::array<T, N> &source)
+      : data_ptr(source.data()), element_count(N) {}
+
+  const T *data() const { return data_ptr; }
+
+  std::size_t size() const { return element_count; }
+
+  bool empty() const { return element_count == 0; }
+
+  const T &operator[](std::size_t index) const { return data_ptr[index]; }
+
+private:
+  const T *data_ptr;
+  std::size_t element_count;
+};
+
+/* Non-owning view over a contiguous row-major 2D buffer. */
+template <typename T> class Span2D {
+public:
+  Span2D() : data_ptr(nullptr), row_count(0), column_count(0) {}
+
+  Span2D(const T *data_in, std::size_t rows_in, std::size_t columns_in)
+      : data_ptr(data_in), row_count(rows_in), column_count(columns_in) {}
+
+  template <std::size_t M, std::size_t N>
+  Span2D(const std::array<std::array<T, N>, M> &source)
+      : data_ptr(source[0].data()), row_count(M), column_count(N) {}
+
+  const T *data() const { return data_ptr; }
+
+  std::size_t rows() const { return row_count; }
+
+  std::size_t columns() const { return column_count; }
+
+  std::size_t size() const { return row_count * column_count; }
+
+  Span<T> row(std::size_t index) const {
+    return Span<T>(data_ptr + index * column_count, column_count);
+  }
+
+private:
+  const T *data_ptr;
+  std::size_t row_count;
+  std::size_t column_count;
+};
+
+/* Owning flat row-major matrix: one contiguous buffer plus dimensions, so a
+ * whole-matrix comparison is a single size check and one linear sweep with
+ * no per-row pointer chasing. Intended to replace vector-of-vectors in
+ * matrix-heavy suites. */
+template <typename T> class Matrix {
+public:
+  Matrix() : row_count(0), column_count(0) {}
+
+  Matrix(std::size_t rows_in, std::size_t columns_in)
+      : row_count(rows_in), column_count(columns_in),
+        storage(rows_in * columns_in) {}
+
+  Matrix(std::size_t rows_in, std::size_t columns_in, const T &fill_value)
+      : row_count(rows_in), column_count(columns_in),
+        storage(rows_in * columns_in, fill_value) {}
+
+  /* Copies a nested vector into flat storage; rows shorter than the first
+   * row are zero padded and longer rows are truncated. A migration helper,
+   * not a hot-path conversion. */
+  explicit Matrix(const std::vector<std::vector<T>> &source)
+      : row_count(source.size()),
+        column_count(source.empty() ? 0 : source[0].size()),
+        storage(row_count * column_count) {
+    for (std::size_t i = 0; i < row_count; i++) {
+      std::size_t copy_count = (source[i].size() < column_count)
+                                   ? source[i].size()
+                                   : column_count;
+      for (std::size_t j = 0; j < copy_count; j++) {
+        storage[i * column_count + j] = source[i][j];
+      }
+    }
+  }
+
+  T *data() { return storage.data(); }
+
+  const T *data() const { return storage.data(); }
+
+  std::size_t rows() const { return row_count; }
+
+  std::size_t columns() const { return column_count; }
+
+  std::size_t size() const { return storage.size(); }
+
+  T &operator()(std::size_t row, std::size_t column) {
+    return storage[row * column_count + column];
+  }
+
+  const T &operator()(std::size_t row, std::size_t column) const {
+    return storage[row * column_count + column];
+  }
+
+  Span2D<T> view() const {
+    return Span2D<T>(storage.data(), row_count, column_count);
+  }
+
+private:
+  std::size_t row_count;
+  std::size_t column_count;
+  std::vector<T> storage;
+};
+
+} // namespace Tester
+
+#endif // MCAP_TESTER_SPAN_HPP
@@ -0,0 +1,15 @@
+/* Translation unit for the separable build. Explicitly instantiates the
+ * MCAPTester element types the generated suites use, so test translation
+ * units built with MCAP_TESTER_SEPARABLE reference these symbols instead of
+ * instantiating and optimizing the template bodies themselves. Member
+ * function templates (the fixed-size overloads) still instantiate at their
+ * call sites. */
+
+#include "MCAP_tester.hpp"
+
+namespace Tester {
+
+template class MCAPTester<float>;
+template class MCAPTester<double>;
+
+} // namespace Tester
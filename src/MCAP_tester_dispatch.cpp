@@ -0,0 +1,97 @@
+/* Runtime resolver for the per-ISA kernel variants. The CPU is probed once
+ * (thread-safely, through the function-local static) and every dispatched
+ * call afterwards is one indirect call through the selected table, so the
+ * probe cost never appears on the sweep path. MCAP_TESTER_DISPATCH_X86 is
+ * set by the build when the SSE2/AVX2/AVX-512 variant objects exist; other
+ * architectures carry a single baseline variant compiled at the project's
+ * own flags (NEON on ARM builds that enable it). */
+
+#include "MCAP_tester_dispatch.hpp"
+
+namespace Tester {
+namespace Dispatch {
+
+#define MCAP_TESTER_DISPATCH_DECLARE(suffix)                                   \
+  std::size_t first_mismatch_float_##suffix(const float *, const float *,      \
+                                            std::size_t, float);               \
+  std::size_t count_mismatch_float_##suffix(const float *, const float *,      \
+                                            std::size_t, float, float *);      \
+  std::size_t first_mismatch_double_##suffix(const double *, const double *,   \
+                                             std::size_t, double);             \
+  std::size_t count_mismatch_double_##suffix(const double *, const double *,   \
+                                             std::size_t, double, double *)
+
+#if defined(MCAP_TESTER_DISPATCH_X86)
+MCAP_TESTER_DISPATCH_DECLARE(sse2);
+MCAP_TESTER_DISPATCH_DECLARE(avx2);
+MCAP_TESTER_DISPATCH_DECLARE(avx512);
+#else
+MCAP_TESTER_DISPATCH_DECLARE(baseline);
+#endif
+
+struct KernelTable {
+  std::size_t (*first_float)(const float *, const float *, std::size_t,
+                             float);
+  std::size_t (*count_float)(const float *, const float *, std::size_t, float,
+                             float *);
+  std::size_t (*first_double)(const double *, const double *, std::size_t,
+                              double);
+  std::size_t (*count_double)(const double *, const double *, std::size_t,
+                              double, double *);
+  const char *name;
+};
+
+#define MCAP_TESTER_DISPATCH_TABLE(suffix)                                     \
+  {                                                                            \
+    first_mismatch_float_##suffix, count_mismatch_float_##suffix,              \
+        first_mismatch_double_##suffix, count_mismatch_double_##suffix,        \
+        #suffix                                                                \
+  }
+
+static KernelTable select_kernel_table() {
+#if defined(MCAP_TESTER_DISPATCH_X86)
+  if (__builtin_cpu_supports("avx512f")) {
+    return MCAP_TESTER_DISPATCH_TABLE(avx512);
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return MCAP_TESTER_DISPATCH_TABLE(avx2);
+  }
+  return MCAP_TESTER_DISPATCH_TABLE(sse2);
+#else
+  return MCAP_TESTER_DISPATCH_TABLE(baseline);
+#endif
+}
+
+static const KernelTable &kernel_table() {
+  static const KernelTable table = select_kernel_table();
+  return table;
+}
+
+std::size_t first_mismatch(const float *actual, const float *expected,
+                           std::size_t size, float tolerance) {
+  return kernel_table().first_float(actual, expected, size, tolerance);
+}
+
+std::size_t first_mismatch(const double *actual, const double *expected,
+                           std::size_t size, double tolerance) {
+  return kernel_table().first_double(actual, expected, size, tolerance);
+}
+
+std::size_t count_mismatch(const float *actual, const float *expected,
+                           std::size_t size, float tolerance,
+                           float *max_error) {
+  return kernel_table().count_float(actual, expected, size, tolerance,
+                                    max_error);
+}
+
+std::size_t count_mismatch(const double *actual, const double *expected,
+                           std::size_t size, double tolerance,
+                           double *max_error) {
+  return kernel_table().count_double(actual, expected, size, tolerance,
+                                     max_error);
+}
+
+const char *active_variant() { return kernel_table().name; }
+
+} // namespace Dispatch
+} // namespace Tester
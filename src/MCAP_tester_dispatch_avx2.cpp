@@ -0,0 +1,2 @@
+#define MCAP_TESTER_DISPATCH_VARIANT avx2
+#include "MCAP_tester_dispatch_kernels.hpp"
@@ -0,0 +1,2 @@
+#define MCAP_TESTER_DISPATCH_VARIANT baseline
+#include "MCAP_tester_dispatch_kernels.hpp"
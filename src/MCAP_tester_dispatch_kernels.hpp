@@ -0,0 +1,47 @@
+/* Shared body for the per-ISA kernel translation units. Each variant .cpp
+ * defines MCAP_TESTER_DISPATCH_VARIANT and is compiled with that ISA's -m
+ * flags, so the header kernels (and the auto-vectorized scalar loops behind
+ * them) instantiate once per instruction set under suffixed symbol names.
+ * The resolver in MCAP_tester_dispatch.cpp picks one set at runtime. */
+
+#ifndef MCAP_TESTER_DISPATCH_VARIANT
+#error "Include MCAP_tester_dispatch_kernels.hpp from a variant .cpp only."
+#endif
+
+#include "MCAP_tester_kernel.hpp"
+
+#define MCAP_TESTER_DISPATCH_PASTE2(name, suffix) name##_##suffix
+#define MCAP_TESTER_DISPATCH_PASTE(name, suffix)                               \
+  MCAP_TESTER_DISPATCH_PASTE2(name, suffix)
+#define MCAP_TESTER_DISPATCH_ENTRY(name)                                       \
+  MCAP_TESTER_DISPATCH_PASTE(name, MCAP_TESTER_DISPATCH_VARIANT)
+
+namespace Tester {
+namespace Dispatch {
+
+std::size_t MCAP_TESTER_DISPATCH_ENTRY(first_mismatch_float)(
+    const float *actual, const float *expected, std::size_t size,
+    float tolerance) {
+  return Kernel::first_mismatch(actual, expected, size, tolerance);
+}
+
+std::size_t MCAP_TESTER_DISPATCH_ENTRY(count_mismatch_float)(
+    const float *actual, const float *expected, std::size_t size,
+    float tolerance, float *max_error) {
+  return Kernel::count_mismatch(actual, expected, size, tolerance, max_error);
+}
+
+std::size_t MCAP_TESTER_DISPATCH_ENTRY(first_mismatch_double)(
+    const double *actual, const double *expected, std::size_t size,
+    double tolerance) {
+  return Kernel::first_mismatch(actual, expected, size, tolerance);
+}
+
+std::size_t MCAP_TESTER_DISPATCH_ENTRY(count_mismatch_double)(
+    const double *actual, const double *expected, std::size_t size,
+    double tolerance, double *max_error) {
+  return Kernel::count_mismatch(actual, expected, size, tolerance, max_error);
+}
+
+} // namespace Dispatch
+} // namespace Tester